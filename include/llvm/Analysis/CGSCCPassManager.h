@@ -516,6 +516,14 @@ LazyCallGraph::SCC &updateCGAndAnalysisManagerForFunctionPass(
 /// \c FunctionAnalysisManagerCGSCCProxy analysis prior to running the function
 /// pass over the SCC to enable a \c FunctionAnalysisManager to be used
 /// within this run safely.
+///
+/// The functions are visited one at a time, even when they belong to
+/// independent leaf SCCs. Running function pipelines concurrently is not
+/// possible here: all functions share one \c LLVMContext, whose constant,
+/// type and metadata uniquing tables are not thread-safe, a function pass
+/// may edit the use lists of globals and constants shared with other
+/// functions, and neither the \c FunctionAnalysisManager caches nor the
+/// \c LazyCallGraph updates performed below are synchronized.
 template <typename FunctionPassT>
 class CGSCCToFunctionPassAdaptor
     : public PassInfoMixin<CGSCCToFunctionPassAdaptor<FunctionPassT>> {
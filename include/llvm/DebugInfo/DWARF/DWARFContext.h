@@ -226,6 +226,13 @@ public:
   /// Get a pointer to a parsed line table corresponding to a compile unit.
   const DWARFDebugLine::LineTable *getLineTableForUnit(DWARFUnit *cu);
 
+  /// Parse all the compile units, their DIEs and their line tables upfront,
+  /// spreading the units over \p NumThreads threads (0 means one per core).
+  /// This is faster than the lazy parsing for clients that walk all of the
+  /// debug info anyway. The context itself is not thread safe: it must not be
+  /// used by other threads while this runs.
+  void parseAllUnits(unsigned NumThreads = 0);
+
   DILineInfo getLineInfoForAddress(uint64_t Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier()) override;
   DILineInfoTable getLineInfoForAddressRange(uint64_t Address, uint64_t Size,
@@ -236,6 +236,9 @@ public:
   const LineTable *getLineTable(uint32_t Offset) const;
   const LineTable *getOrParseLineTable(const DWARFDataExtractor &DebugLineData,
                                        uint32_t Offset);
+  /// Cache \p LT, parsed by the caller, as the line table at \p Offset
+  /// unless one has already been parsed there.
+  const LineTable *addLineTable(uint32_t Offset, LineTable LT);
 
 private:
   struct ParsingState {
@@ -0,0 +1,110 @@
+//===- SymbolizationIndex.h -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the SymbolizationIndex class, a persistent cache of the
+// symbolization results for one binary.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZATIONINDEX_H
+#define LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZATIONINDEX_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace llvm {
+
+class MemoryBuffer;
+
+namespace symbolize {
+
+/// An on-disk index from the addresses of a binary to their inlined frames.
+///
+/// Indexes are named after the build ID of the binary, so a symbolizer that
+/// is restarted answers the addresses it has already seen straight from the
+/// index, without building the symbol maps or parsing the debug info again.
+///
+/// The file is memory-mapped and searched in place. It holds a header, the
+/// entries sorted by address, their frames, and a string table. Results
+/// recorded with insert() are kept in memory until write() merges them into
+/// the file.
+class SymbolizationIndex {
+public:
+  /// Open the index stored at \p Path. The file is only used if it was
+  /// written with the same \p Flags, which encode the symbolizer options
+  /// affecting the results. A missing, stale or malformed file gives an empty
+  /// index.
+  SymbolizationIndex(std::string Path, uint32_t Flags);
+  ~SymbolizationIndex();
+
+  /// Return the frames recorded for \p Address, if any.
+  Optional<DIInliningInfo> lookup(uint64_t Address) const;
+
+  /// Record the frames symbolized for \p Address.
+  void insert(uint64_t Address, const DIInliningInfo &Info);
+
+  /// Merge the recorded results into the file, along with the entries other
+  /// symbolizers added since it was loaded. Writers are serialized with a
+  /// lock file, and the file is replaced atomically, so concurrent readers
+  /// always see a complete index.
+  Error write();
+
+  struct Header {
+    char Magic[8];
+    support::ulittle32_t Version;
+    support::ulittle32_t Flags;
+    support::ulittle32_t NumEntries;
+    support::ulittle32_t NumFrames;
+    support::ulittle32_t StringTableSize;
+  };
+
+  struct Entry {
+    support::ulittle64_t Address;
+    support::ulittle32_t FirstFrame;
+    support::ulittle32_t NumFrames;
+  };
+
+  /// A frame of an entry. Names are offsets into the string table.
+  struct Frame {
+    support::ulittle32_t FunctionName;
+    support::ulittle32_t FileName;
+    support::ulittle32_t Line;
+    support::ulittle32_t Column;
+    support::ulittle32_t StartLine;
+    support::ulittle32_t Discriminator;
+  };
+
+private:
+  void load();
+  Error writeLocked();
+  Optional<DIInliningInfo> decode(const Entry &E) const;
+
+  std::string Path;
+  uint32_t Flags;
+  std::unique_ptr<MemoryBuffer> Buffer;
+  ArrayRef<Entry> Entries;
+  ArrayRef<Frame> Frames;
+  StringRef StringTable;
+
+  /// Results recorded since the file was loaded.
+  std::map<uint64_t, DIInliningInfo> NewEntries;
+};
+
+} // end namespace symbolize
+} // end namespace llvm
+
+#endif // LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZATIONINDEX_H
@@ -15,6 +15,7 @@
 #define LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZE_H
 
 #include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
+#include "llvm/DebugInfo/Symbolize/SymbolizationIndex.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Error.h"
@@ -42,6 +43,11 @@ public:
     bool RelativeAddresses : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    /// If not empty, the inlined frames symbolized for binaries that have a
+    /// build ID are cached in an index in this directory, and looked up there
+    /// first by later symbolizers. Only symbolizeInlinedCode() uses the
+    /// index.
+    std::string IndexDirectory;
 
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
@@ -81,6 +87,12 @@ private:
   Expected<SymbolizableModule *>
   getOrCreateModuleInfo(const std::string &ModuleName);
 
+  /// Returns the SymbolizationIndex of a module, or nullptr if the module
+  /// doesn't have a build ID or its object file couldn't be loaded. Loading
+  /// errors are reported once, like in getOrCreateModuleInfo().
+  Expected<SymbolizationIndex *>
+  getOrCreateIndex(const std::string &ModuleName);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -100,6 +112,9 @@ private:
 
   std::map<std::string, std::unique_ptr<SymbolizableModule>> Modules;
 
+  /// \brief Persistent indexes of the modules, when Opts.IndexDirectory is set.
+  std::map<std::string, std::unique_ptr<SymbolizationIndex>> Indexes;
+
   /// \brief Contains cached results of getOrCreateObjectPair().
   std::map<std::pair<std::string, std::string>, ObjectPair>
       ObjectPairForPathArch;
@@ -26,6 +26,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include <algorithm>
+#include <functional>
 #include <memory>
 
 namespace llvm {
@@ -106,6 +107,40 @@ private:
   ObjectCache *ObjCache = nullptr;
 };
 
+/// @brief Compile functor that can be called from several threads at once.
+///
+///   A TargetMachine can't be shared between threads, so this creates one for
+/// every module it compiles and hands the work to SimpleCompiler. The
+/// TargetMachine factory is called from the compiling threads, so it must be
+/// safe to call concurrently (Target::createTargetMachine is). The modules
+/// compiled concurrently must belong to different LLVMContexts, and the
+/// ObjectCache, if any, must be thread-safe.
+class ConcurrentIRCompiler {
+public:
+
+  using CompileResult = SimpleCompiler::CompileResult;
+  using TargetMachineFactory = std::function<std::unique_ptr<TargetMachine>()>;
+
+  /// @brief Construct a compile functor creating targets with CreateTM, which
+  ///        may be called from several threads at once.
+  ConcurrentIRCompiler(TargetMachineFactory CreateTM,
+                       ObjectCache *ObjCache = nullptr)
+    : CreateTM(std::move(CreateTM)), ObjCache(ObjCache) {}
+
+  /// @brief Set an ObjectCache to query before compiling.
+  void setObjectCache(ObjectCache *NewCache) { ObjCache = NewCache; }
+
+  /// @brief Compile a Module to an ObjectFile.
+  CompileResult operator()(Module &M) {
+    std::unique_ptr<TargetMachine> TM = CreateTM();
+    return SimpleCompiler(*TM, ObjCache)(M);
+  }
+
+private:
+  TargetMachineFactory CreateTM;
+  ObjectCache *ObjCache = nullptr;
+};
+
 } // end namespace orc
 
 } // end namespace llvm
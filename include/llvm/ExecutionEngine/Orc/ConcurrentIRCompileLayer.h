@@ -0,0 +1,255 @@
+//===- ConcurrentIRCompileLayer.h - Compile IR on a thread pool -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definition for a JIT layer that compiles IR modules on a pool
+// of threads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_CONCURRENTIRCOMPILELAYER_H
+#define LLVM_EXECUTIONENGINE_ORC_CONCURRENTIRCOMPILELAYER_H
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/IR/GlobalValue.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <list>
+#include <memory>
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+/// @brief Concurrent IR compiling layer.
+///
+///   This layer starts compiling each IR module added via addModule on a
+/// thread pool and returns immediately. The resulting object file is added to
+/// the layer below, which must implement the object layer concept, the first
+/// time the address of one of its symbols is requested (via
+/// JITSymbol::getAddress) or when the module is finalized. Only then does the
+/// caller wait for the compile to finish.
+///
+///   Several modules are compiled at the same time, so the compile functor
+/// must be safe to call concurrently (e.g. ConcurrentIRCompiler), and every
+/// module must live in its own LLVMContext. The layer itself is not
+/// thread-safe: its methods must be called from a single thread.
+template <typename BaseLayerT, typename CompileFtor>
+class ConcurrentIRCompileLayer {
+public:
+
+  using BaseLayerHandleT = typename BaseLayerT::ObjHandleT;
+
+private:
+  using CompileResult =
+      decltype(std::declval<CompileFtor &>()(std::declval<Module &>()));
+
+  class CompilingModule {
+  public:
+    CompilingModule(std::shared_ptr<Module> M,
+                    std::shared_ptr<JITSymbolResolver> Resolver)
+        : M(std::move(M)), Resolver(std::move(Resolver)) {
+      // The module must not be touched on this thread once its compile has
+      // started, so record the symbols it defines up front.
+      Mangler Mang;
+      for (const auto &GO : this->M->global_objects()) {
+        // Modules don't "provide" decls or common symbols.
+        if (GO.isDeclaration() || GO.hasCommonLinkage())
+          continue;
+        std::string MangledName;
+        {
+          raw_string_ostream MangledNameStream(MangledName);
+          Mang.getNameWithPrefix(MangledNameStream, &GO, false);
+        }
+        Symbols[MangledName] =
+            std::make_pair(JITSymbolFlags::fromGlobalValue(GO),
+                           GO.hasDefaultVisibility());
+      }
+    }
+
+    void startCompile(ThreadPool &Pool, CompileFtor &Compile) {
+      Compiled = Pool.async([this, &Compile]() {
+        Obj = std::make_shared<CompileResult>(Compile(*M));
+      });
+    }
+
+    JITSymbol find(StringRef Name, bool ExportedSymbolsOnly, BaseLayerT &B) {
+      switch (EmitState) {
+      case NotEmitted: {
+        auto I = Symbols.find(Name);
+        if (I == Symbols.end() || (ExportedSymbolsOnly && !I->second.second))
+          return nullptr;
+        // Create a std::string version of Name to capture here - the argument
+        // (a StringRef) may go away before the lambda is executed.
+        // FIXME: Use capture-init when we move to C++14.
+        std::string PName = Name;
+        auto GetAddress =
+          [this, ExportedSymbolsOnly, PName, &B]() -> Expected<JITTargetAddress> {
+            if (this->EmitState == Emitting)
+              return 0;
+            else if (this->EmitState == NotEmitted)
+              if (auto Err = this->emitToBaseLayer(B))
+                return std::move(Err);
+            if (auto Sym = B.findSymbolIn(Handle, PName, ExportedSymbolsOnly))
+              return Sym.getAddress();
+            else if (auto Err = Sym.takeError())
+              return std::move(Err);
+            else
+              llvm_unreachable("Successful symbol lookup should return "
+                               "definition address here");
+        };
+        return JITSymbol(std::move(GetAddress), I->second.first);
+      }
+      case Emitting:
+        // Adding the object can trigger a recursive call to 'find', but any
+        // symbol in this module would already have been found internally, so
+        // just return a nullptr here.
+        return nullptr;
+      case Emitted:
+        return B.findSymbolIn(Handle, Name, ExportedSymbolsOnly);
+      }
+      llvm_unreachable("Invalid emit-state.");
+    }
+
+    Error removeFromBaseLayer(BaseLayerT &BaseLayer) {
+      // Don't free the module while it is being compiled.
+      Compiled.wait();
+      if (EmitState != NotEmitted)
+        return BaseLayer.removeObject(Handle);
+      return Error::success();
+    }
+
+    Error emitAndFinalize(BaseLayerT &BaseLayer) {
+      assert(EmitState != Emitting &&
+             "Cannot emitAndFinalize while already emitting");
+      if (EmitState == NotEmitted)
+        if (auto Err = emitToBaseLayer(BaseLayer))
+          return Err;
+      return BaseLayer.emitAndFinalize(Handle);
+    }
+
+  private:
+    Error emitToBaseLayer(BaseLayerT &BaseLayer) {
+      EmitState = Emitting;
+      Compiled.wait();
+      // The symbols will be looked up in the base layer from now on, and the
+      // module is no longer needed.
+      Symbols.clear();
+      M.reset();
+      auto HandleOrErr =
+          BaseLayer.addObject(std::move(Obj), std::move(Resolver));
+      if (!HandleOrErr)
+        return HandleOrErr.takeError();
+      Handle = std::move(*HandleOrErr);
+      EmitState = Emitted;
+      return Error::success();
+    }
+
+    enum { NotEmitted, Emitting, Emitted } EmitState = NotEmitted;
+    BaseLayerHandleT Handle;
+    std::shared_ptr<Module> M;
+    std::shared_ptr<JITSymbolResolver> Resolver;
+    std::shared_future<void> Compiled;
+    std::shared_ptr<CompileResult> Obj;
+    /// The flags of each defined symbol, and whether it has default
+    /// visibility.
+    StringMap<std::pair<JITSymbolFlags, bool>> Symbols;
+  };
+
+  using ModuleListT = std::list<std::unique_ptr<CompilingModule>>;
+
+  BaseLayerT &BaseLayer;
+  CompileFtor Compile;
+  ModuleListT ModuleList;
+  // Declared last so that it is destroyed first, waiting for the compiles
+  // still running on the modules in ModuleList.
+  ThreadPool Pool;
+
+public:
+
+  /// @brief Handle to a module.
+  using ModuleHandleT = typename ModuleListT::iterator;
+
+  /// @brief Construct a ConcurrentIRCompileLayer with the given BaseLayer,
+  ///        which must implement the ObjectLayer concept, compiling on
+  ///        ThreadCount threads.
+  ConcurrentIRCompileLayer(BaseLayerT &BaseLayer, CompileFtor Compile,
+                           unsigned ThreadCount =
+                               heavyweight_hardware_concurrency())
+      : BaseLayer(BaseLayer), Compile(std::move(Compile)),
+        Pool(ThreadCount) {}
+
+  /// @brief Get a reference to the compiler functor.
+  CompileFtor& getCompiler() { return Compile; }
+
+  /// @brief Start compiling the module on the thread pool.
+  ///
+  /// @return A handle for the added module.
+  Expected<ModuleHandleT>
+  addModule(std::shared_ptr<Module> M,
+            std::shared_ptr<JITSymbolResolver> Resolver) {
+    auto H = ModuleList.insert(
+        ModuleList.end(),
+        llvm::make_unique<CompilingModule>(std::move(M), std::move(Resolver)));
+    (*H)->startCompile(Pool, Compile);
+    return H;
+  }
+
+  /// @brief Remove the module associated with the handle H, waiting for its
+  ///        compile to finish first.
+  Error removeModule(ModuleHandleT H) {
+    Error Err = (*H)->removeFromBaseLayer(BaseLayer);
+    ModuleList.erase(H);
+    return Err;
+  }
+
+  /// @brief Search for the given named symbol.
+  /// @param Name The name of the symbol to search for.
+  /// @param ExportedSymbolsOnly If true, search only for exported symbols.
+  /// @return A handle for the given named symbol, if it exists.
+  JITSymbol findSymbol(const std::string &Name, bool ExportedSymbolsOnly) {
+    // Look for the symbol among the objects added to the base layer.
+    if (auto Symbol = BaseLayer.findSymbol(Name, ExportedSymbolsOnly))
+      return Symbol;
+
+    // If not found then search the modules being compiled. If any of these
+    // contain a definition of 'Name' then they will return a JITSymbol that
+    // will wait for the compile when the symbol address is requested.
+    for (auto &CM : ModuleList)
+      if (auto Symbol = CM->find(Name, ExportedSymbolsOnly, BaseLayer))
+        return Symbol;
+
+    // If no definition found anywhere return a null symbol.
+    return nullptr;
+  }
+
+  /// @brief Get the address of the given symbol in the compiled module
+  ///        represented by the handle H.
+  JITSymbol findSymbolIn(ModuleHandleT H, const std::string &Name,
+                         bool ExportedSymbolsOnly) {
+    return (*H)->find(Name, ExportedSymbolsOnly, BaseLayer);
+  }
+
+  /// @brief Wait for the module represented by the given handle to be
+  ///        compiled, then emit and finalize it.
+  /// @param H Handle for module to emit/finalize.
+  Error emitAndFinalize(ModuleHandleT H) {
+    return (*H)->emitAndFinalize(BaseLayer);
+  }
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_CONCURRENTIRCOMPILELAYER_H
@@ -20,8 +20,11 @@
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/Support/Memory.h"
 #include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
 #include <system_error>
+#include <vector>
 
 namespace llvm {
 
@@ -40,7 +43,50 @@ namespace llvm {
 /// directly.  Clients of MCJIT should call MCJIT::finalizeObject.
 class SectionMemoryManager : public RTDyldMemoryManager {
 public:
-  SectionMemoryManager() = default;
+  /// This enum describes the various reasons to allocate pages from
+  /// allocateMappedMemory.
+  enum class AllocationPurpose {
+    Code,
+    ROData,
+    RWData,
+  };
+
+  /// Implementations of this interface are used by SectionMemoryManager to
+  /// request pages from the operating system.
+  class MemoryMapper {
+  public:
+    /// This method attempts to allocate \p NumBytes bytes of virtual memory for
+    /// \p Purpose.  \p NearBlock may point to an existing allocation, in which
+    /// case an attempt is made to allocate more memory near the existing
+    /// block.  The actual allocated address is not guaranteed to be near the
+    /// requested address.  \p Flags is used to set the initial protection
+    /// flags for the block of the memory.  \p EC [out] returns an object
+    /// describing any error that occurs.
+    ///
+    /// The returned block may be larger than \p NumBytes.
+    virtual sys::MemoryBlock
+    allocateMappedMemory(AllocationPurpose Purpose, size_t NumBytes,
+                         const sys::MemoryBlock *const NearBlock,
+                         unsigned Flags, std::error_code &EC) = 0;
+
+    /// This method sets the protection flags for a block of memory to the
+    /// state specified by \p Flags.  The behavior is not specified if the
+    /// memory was not allocated using the allocateMappedMemory method.
+    virtual std::error_code protectMappedMemory(const sys::MemoryBlock &Block,
+                                                unsigned Flags) = 0;
+
+    /// This method releases a block of memory that was allocated with the
+    /// allocateMappedMemory method.  It should not be used to release any
+    /// memory block allocated any other way.
+    virtual std::error_code releaseMappedMemory(sys::MemoryBlock &M) = 0;
+
+    virtual ~MemoryMapper();
+  };
+
+  /// Creates a SectionMemoryManager instance with \p MM as the associated
+  /// memory mapper.  If \p MM is nullptr then a default memory mapper is used
+  /// that directly calls into the operating system.
+  SectionMemoryManager(MemoryMapper *MM = nullptr);
   SectionMemoryManager(const SectionMemoryManager&) = delete;
   void operator=(const SectionMemoryManager&) = delete;
   ~SectionMemoryManager() override;
@@ -110,7 +156,7 @@ private:
     sys::MemoryBlock Near;
   };
 
-  uint8_t *allocateSection(MemoryGroup &MemGroup, uintptr_t Size,
+  uint8_t *allocateSection(AllocationPurpose Purpose, uintptr_t Size,
                            unsigned Alignment);
 
   std::error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
@@ -119,6 +165,61 @@ private:
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
+  MemoryMapper &MMapper;
+};
+
+/// A MemoryMapper that keeps the pages released by SectionMemoryManagers and
+/// hands them out again.
+///
+/// JITs that create and discard many small objects, each with its own
+/// SectionMemoryManager, would otherwise map and unmap pages for every one of
+/// them and fragment their address space.  Requests are rounded up to slabs
+/// of a power of two pages, and released slabs are kept in a free list per
+/// size.  A reused slab is only protected again if its permissions were
+/// changed, so data slabs are recycled without any system call.
+///
+/// One instance is meant to be shared by all the memory managers of a JIT,
+/// and must outlive them.
+class RecyclingMemoryMapper : public SectionMemoryManager::MemoryMapper {
+public:
+  /// Keep at most \p MaxCachedBytes of released memory.  Requests larger
+  /// than \p MaxSlabSize bytes are passed to the operating system.
+  RecyclingMemoryMapper(size_t MaxCachedBytes = 64 << 20,
+                        size_t MaxSlabSize = 1 << 20);
+  RecyclingMemoryMapper(const RecyclingMemoryMapper &) = delete;
+  void operator=(const RecyclingMemoryMapper &) = delete;
+  ~RecyclingMemoryMapper() override;
+
+  sys::MemoryBlock
+  allocateMappedMemory(SectionMemoryManager::AllocationPurpose Purpose,
+                       size_t NumBytes, const sys::MemoryBlock *const NearBlock,
+                       unsigned Flags, std::error_code &EC) override;
+
+  std::error_code protectMappedMemory(const sys::MemoryBlock &Block,
+                                      unsigned Flags) override;
+
+  std::error_code releaseMappedMemory(sys::MemoryBlock &M) override;
+
+  /// Returns the number of bytes of released memory kept for reuse.
+  size_t getCachedBytes() const;
+
+private:
+  struct Slab {
+    size_t Size;
+    // The protection flags of the whole slab, or ~0U if parts of it were
+    // protected differently.
+    unsigned Flags;
+  };
+
+  mutable std::mutex Mutex;
+  // The slabs given out, by base address.
+  std::map<uintptr_t, Slab> LiveSlabs;
+  // The released slabs, indexed by the log2 of their number of pages.
+  std::vector<std::vector<std::pair<sys::MemoryBlock, unsigned>>> FreeSlabs;
+  size_t CachedBytes = 0;
+  size_t MaxCachedBytes;
+  size_t MaxSlabSize;
+  size_t PageSize;
 };
 
 } // end namespace llvm
@@ -11,6 +11,7 @@
 #define LLVM_MC_MCASSEMBLER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringRef.h"
@@ -116,6 +117,14 @@ private:
 
   MCDwarfLineTableParams LTParams;
 
+  /// The fragments of each section, indexed by ordinal, whose size may change
+  /// during relaxation. Built at the start of layout().
+  std::vector<std::vector<MCFragment *>> RelaxableFragments;
+
+  /// The sections, by ordinal, that have to be relaxed again because some
+  /// section changed size since they were last found stable.
+  BitVector SectionsToRelax;
+
   /// The set of function symbols for which a .thumb_func directive has
   /// been seen.
   //
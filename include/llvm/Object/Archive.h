@@ -14,6 +14,8 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
@@ -22,6 +24,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
@@ -260,6 +263,11 @@ public:
   // check if a symbol is in the archive
   Expected<Optional<Child>> findSym(StringRef name) const;
 
+  /// Look up all of \p Names in the symbol table. Returns, for each name, the
+  /// member that defines it or None, as findSym() would.
+  Expected<std::vector<Optional<Child>>>
+  findSyms(ArrayRef<StringRef> Names) const;
+
   bool isEmpty() const;
   bool hasSymbolTable() const;
   StringRef getSymbolTable() const { return SymbolTable; }
@@ -271,8 +279,15 @@ public:
   }
 
 private:
+  /// Build SymbolMap if needed. Safe to call from several threads.
+  void buildSymbolMap() const;
+
   StringRef SymbolTable;
   StringRef StringTable;
+  /// Index of the symbol table by name, built on the first lookup. When a name
+  /// is defined several times, the first definition is kept.
+  mutable DenseMap<StringRef, Symbol> SymbolMap;
+  mutable llvm::once_flag SymbolMapBuilt;
 
   StringRef FirstRegularData;
   uint16_t FirstRegularStartOfFile = -1;
@@ -217,6 +217,20 @@ public:
                                       bool DebugLogging = false,
                                       bool PrepareForThinLTO = false);
 
+  /// Construct a cheap, fixed function simplification pipeline.
+  ///
+  /// This only runs the basic cleanup passes and is used in place of the
+  /// pipeline built by \c buildFunctionSimplificationPipeline for functions
+  /// whose entry is cold according to the profile, when cold function tiering
+  /// is enabled with \c -enable-npm-cold-function-tiering. The setting applies
+  /// to the default, ThinLTO pre-link and ThinLTO backend pipelines. The full
+  /// LTO pipeline built by \c buildLTODefaultPipeline is not tiered.
+  ///
+  /// Note that \p Level cannot be `O0` here.
+  FunctionPassManager
+  buildColdFunctionSimplificationPipeline(OptimizationLevel Level,
+                                          bool DebugLogging = false);
+
   /// Construct the core LLVM module canonicalization and simplification
   /// pipeline.
   ///
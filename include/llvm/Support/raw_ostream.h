@@ -346,6 +346,11 @@ public:
 #endif
     pwrite_impl(Ptr, Size, Offset);
   }
+
+  /// Hint that about \p ExtraSize more bytes are going to be written to the
+  /// stream, so that it can allocate its storage once up front instead of
+  /// growing it piecewise. The default implementation does nothing.
+  virtual void reserveExtraSpace(uint64_t ExtraSize) {}
 };
 
 //===----------------------------------------------------------------------===//
@@ -407,6 +412,10 @@ public:
 
   bool supportsSeeking() { return SupportsSeeking; }
 
+  /// Grow the buffer of a buffered stream so that large outputs are written
+  /// with few, big writes.
+  void reserveExtraSpace(uint64_t ExtraSize) override;
+
   /// Flushes the stream and repositions the underlying file descriptor position
   /// to the offset specified from the beginning of the file.
   uint64_t seek(uint64_t off);
@@ -511,6 +520,10 @@ public:
 
   void flush() = delete;
 
+  void reserveExtraSpace(uint64_t ExtraSize) override {
+    OS.reserve(tell() + ExtraSize);
+  }
+
   /// Return a StringRef for the vector contents.
   StringRef str() { return StringRef(OS.data(), OS.size()); }
 };
@@ -40,6 +40,8 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdint>
@@ -583,6 +585,55 @@ DWARFContext::getLineTableForUnit(DWARFUnit *U) {
   return Line->getOrParseLineTable(lineData, stmtOffset);
 }
 
+void DWARFContext::parseAllUnits(unsigned NumThreads) {
+  // The state shared by the units is created lazily, set it up before any
+  // unit is parsed.
+  parseCompileUnits();
+  getDebugAbbrev();
+  if (!Line)
+    Line.reset(new DWARFDebugLine);
+
+  struct UnitLineTable {
+    uint32_t Offset = 0;
+    bool Parsed = false;
+    DWARFDebugLine::LineTable Table;
+  };
+  std::vector<UnitLineTable> LineTables(CUs.size());
+
+  // Extracting the DIEs of a unit and parsing its line table only read the
+  // sections and the abbreviations, and only write to the unit, so units are
+  // processed concurrently. The line tables are parsed on the side and cached
+  // once all the units are done.
+  ThreadPool Pool(NumThreads ? NumThreads
+                             : llvm::heavyweight_hardware_concurrency());
+  for (unsigned I = 0, E = CUs.size(); I != E; ++I) {
+    DWARFUnit *U = CUs[I].get();
+    UnitLineTable &LT = LineTables[I];
+    Pool.async([this, U, &LT] {
+      auto UnitDIE = U->getUnitDIE(/*ExtractUnitDIEOnly=*/false);
+      if (!UnitDIE)
+        return;
+      auto Offset = toSectionOffset(UnitDIE.find(DW_AT_stmt_list));
+      if (!Offset)
+        return;
+      LT.Offset = *Offset + U->getLineTableOffset();
+      if (LT.Offset >= U->getLineSection().Data.size() ||
+          Line->getLineTable(LT.Offset))
+        return;
+      DWARFDataExtractor LineData(*DObj, U->getLineSection(), isLittleEndian(),
+                                  U->getAddressByteSize());
+      uint32_t ParseOffset = LT.Offset;
+      LT.Parsed = LT.Table.parse(LineData, &ParseOffset);
+    });
+  }
+  Pool.wait();
+
+  // Tables that failed to parse are left to getLineTableForUnit().
+  for (auto &LT : LineTables)
+    if (LT.Parsed)
+      Line->addLineTable(LT.Offset, std::move(LT.Table));
+}
+
 void DWARFContext::parseCompileUnits() {
   CUs.parse(*this, DObj->getInfoSection());
 }
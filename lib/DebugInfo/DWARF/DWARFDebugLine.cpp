@@ -393,6 +393,12 @@ DWARFDebugLine::getOrParseLineTable(const DWARFDataExtractor &DebugLineData,
   return LT;
 }
 
+const DWARFDebugLine::LineTable *
+DWARFDebugLine::addLineTable(uint32_t Offset, LineTable LT) {
+  return &LineTableMap.insert(std::make_pair(Offset, std::move(LT)))
+              .first->second;
+}
+
 bool DWARFDebugLine::LineTable::parse(const DWARFDataExtractor &DebugLineData,
                                       uint32_t *OffsetPtr) {
   const uint32_t DebugLineOffset = *OffsetPtr;
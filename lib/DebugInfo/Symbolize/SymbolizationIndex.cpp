@@ -0,0 +1,232 @@
+//===- SymbolizationIndex.cpp ---------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of the persistent symbolization index.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/Symbolize/SymbolizationIndex.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace symbolize;
+
+static const char IndexMagic[8] = {'L', 'L', 'V', 'M', 'S', 'Y', 'M', 'I'};
+static const uint32_t IndexVersion = 1;
+
+static_assert(sizeof(SymbolizationIndex::Header) == 28 &&
+                  sizeof(SymbolizationIndex::Entry) == 16 &&
+                  sizeof(SymbolizationIndex::Frame) == 24,
+              "the index file layout must not depend on the host");
+
+SymbolizationIndex::SymbolizationIndex(std::string Path, uint32_t Flags)
+    : Path(std::move(Path)), Flags(Flags) {
+  load();
+}
+
+SymbolizationIndex::~SymbolizationIndex() = default;
+
+void SymbolizationIndex::load() {
+  Buffer.reset();
+  Entries = ArrayRef<Entry>();
+  Frames = ArrayRef<Frame>();
+  StringTable = StringRef();
+
+  auto BufferOrErr = MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                           /*RequiresNullTerminator=*/false);
+  if (!BufferOrErr)
+    return;
+  StringRef Data = (*BufferOrErr)->getBuffer();
+  if (Data.size() < sizeof(Header))
+    return;
+  const auto *H = reinterpret_cast<const Header *>(Data.data());
+  if (memcmp(H->Magic, IndexMagic, sizeof(IndexMagic)) != 0 ||
+      H->Version != IndexVersion || H->Flags != Flags)
+    return;
+  uint64_t EntriesSize = uint64_t(H->NumEntries) * sizeof(Entry);
+  uint64_t FramesSize = uint64_t(H->NumFrames) * sizeof(Frame);
+  if (Data.size() !=
+      sizeof(Header) + EntriesSize + FramesSize + H->StringTableSize)
+    return;
+
+  const char *Cur = Data.data() + sizeof(Header);
+  Entries = makeArrayRef(reinterpret_cast<const Entry *>(Cur), H->NumEntries);
+  Cur += EntriesSize;
+  Frames = makeArrayRef(reinterpret_cast<const Frame *>(Cur), H->NumFrames);
+  Cur += FramesSize;
+  StringTable = StringRef(Cur, H->StringTableSize);
+  Buffer = std::move(*BufferOrErr);
+}
+
+Optional<DIInliningInfo>
+SymbolizationIndex::decode(const SymbolizationIndex::Entry &E) const {
+  if (uint64_t(E.FirstFrame) + E.NumFrames > Frames.size())
+    return None;
+  auto GetString = [&](uint32_t Offset) -> Optional<std::string> {
+    if (Offset >= StringTable.size())
+      return None;
+    StringRef Str = StringTable.drop_front(Offset);
+    size_t End = Str.find('\0');
+    if (End == StringRef::npos)
+      return None;
+    return Str.take_front(End).str();
+  };
+
+  DIInliningInfo Info;
+  for (const Frame &F : Frames.slice(E.FirstFrame, E.NumFrames)) {
+    DILineInfo LineInfo;
+    Optional<std::string> FunctionName = GetString(F.FunctionName);
+    Optional<std::string> FileName = GetString(F.FileName);
+    if (!FunctionName || !FileName)
+      return None;
+    LineInfo.FunctionName = std::move(*FunctionName);
+    LineInfo.FileName = std::move(*FileName);
+    LineInfo.Line = F.Line;
+    LineInfo.Column = F.Column;
+    LineInfo.StartLine = F.StartLine;
+    LineInfo.Discriminator = F.Discriminator;
+    Info.addFrame(LineInfo);
+  }
+  return Info;
+}
+
+Optional<DIInliningInfo> SymbolizationIndex::lookup(uint64_t Address) const {
+  auto NewIt = NewEntries.find(Address);
+  if (NewIt != NewEntries.end())
+    return NewIt->second;
+
+  auto It = std::lower_bound(
+      Entries.begin(), Entries.end(), Address,
+      [](const Entry &E, uint64_t Address) { return E.Address < Address; });
+  if (It == Entries.end() || It->Address != Address)
+    return None;
+  return decode(*It);
+}
+
+void SymbolizationIndex::insert(uint64_t Address, const DIInliningInfo &Info) {
+  NewEntries[Address] = Info;
+}
+
+Error SymbolizationIndex::write() {
+  if (NewEntries.empty())
+    return Error::success();
+
+  // Serialize the writers of the index, so that concurrent symbolizers don't
+  // drop each other's entries.
+  while (true) {
+    LockFileManager Locked(Path);
+    switch (Locked) {
+    case LockFileManager::LFS_Error:
+      return make_error<StringError>("cannot lock " + Twine(Path) + ": " +
+                                         Locked.getErrorMessage(),
+                                     inconvertibleErrorCode());
+    case LockFileManager::LFS_Owned:
+      return writeLocked();
+    case LockFileManager::LFS_Shared:
+      // Another symbolizer is writing the index, merge with its result.
+      if (Locked.waitForUnlock() == LockFileManager::Res_Timeout)
+        Locked.unsafeRemoveLockFile();
+      break;
+    }
+  }
+}
+
+Error SymbolizationIndex::writeLocked() {
+  // The file may have been updated since it was loaded, merge with its
+  // current contents. Entries that can't be decoded are dropped, they will be
+  // symbolized again.
+  load();
+  std::map<uint64_t, DIInliningInfo> AllEntries;
+  for (const Entry &E : Entries)
+    if (Optional<DIInliningInfo> Info = decode(E))
+      AllEntries[E.Address] = std::move(*Info);
+  for (auto &KV : NewEntries)
+    AllEntries[KV.first] = KV.second;
+
+  std::vector<Entry> OutEntries;
+  std::vector<Frame> OutFrames;
+  std::string Strings;
+  StringMap<uint32_t> StringOffsets;
+  auto AddString = [&](StringRef Str) -> uint32_t {
+    auto Inserted = StringOffsets.insert(std::make_pair(Str, Strings.size()));
+    if (Inserted.second) {
+      Strings.append(Str.begin(), Str.end());
+      Strings.push_back('\0');
+    }
+    return Inserted.first->second;
+  };
+
+  OutEntries.reserve(AllEntries.size());
+  for (const auto &KV : AllEntries) {
+    Entry E;
+    E.Address = KV.first;
+    E.FirstFrame = OutFrames.size();
+    E.NumFrames = KV.second.getNumberOfFrames();
+    OutEntries.push_back(E);
+    for (uint32_t I = 0, N = KV.second.getNumberOfFrames(); I != N; ++I) {
+      DILineInfo LineInfo = KV.second.getFrame(I);
+      Frame F;
+      F.FunctionName = AddString(LineInfo.FunctionName);
+      F.FileName = AddString(LineInfo.FileName);
+      F.Line = LineInfo.Line;
+      F.Column = LineInfo.Column;
+      F.StartLine = LineInfo.StartLine;
+      F.Discriminator = LineInfo.Discriminator;
+      OutFrames.push_back(F);
+    }
+  }
+
+  Header H;
+  memcpy(H.Magic, IndexMagic, sizeof(IndexMagic));
+  H.Version = IndexVersion;
+  H.Flags = Flags;
+  H.NumEntries = OutEntries.size();
+  H.NumFrames = OutFrames.size();
+  H.StringTableSize = Strings.size();
+
+  // Write to a temporary file first and rename it over the index so that
+  // other symbolizers never map a partially written file.
+  int FD;
+  SmallString<128> TempPath;
+  if (std::error_code EC =
+          sys::fs::createUniqueFile(Path + "-%%%%%%.tmp", FD, TempPath))
+    return errorCodeToError(EC);
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(reinterpret_cast<const char *>(&H), sizeof(H));
+    OS.write(reinterpret_cast<const char *>(OutEntries.data()),
+             OutEntries.size() * sizeof(Entry));
+    OS.write(reinterpret_cast<const char *>(OutFrames.data()),
+             OutFrames.size() * sizeof(Frame));
+    OS << Strings;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return make_error<StringError>("cannot write " + Twine(TempPath),
+                                     inconvertibleErrorCode());
+    }
+  }
+  if (std::error_code EC = sys::fs::rename(TempPath, Path)) {
+    sys::fs::remove(TempPath);
+    return errorCodeToError(EC);
+  }
+
+  NewEntries.clear();
+  load();
+  return Error::success();
+}
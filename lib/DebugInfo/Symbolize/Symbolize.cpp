@@ -16,6 +16,7 @@
 #include "SymbolizableObjectFile.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/Config/config.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -78,9 +79,37 @@ Expected<DILineInfo> LLVMSymbolizer::symbolizeCode(const std::string &ModuleName
   return LineInfo;
 }
 
+/// Returns true if every frame of \p Info has a file name and a line.
+static bool isFullySymbolized(const DIInliningInfo &Info) {
+  if (Info.getNumberOfFrames() == 0)
+    return false;
+  for (uint32_t I = 0, N = Info.getNumberOfFrames(); I != N; ++I) {
+    DILineInfo Frame = Info.getFrame(I);
+    // DILineInfo uses "<invalid>" for a file name it couldn't find.
+    if (Frame.FileName == "<invalid>" || Frame.Line == 0)
+      return false;
+  }
+  return true;
+}
+
 Expected<DIInliningInfo>
 LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
                                      uint64_t ModuleOffset) {
+  // Addresses that have been symbolized before are answered from the index,
+  // without creating the module. The index is keyed on the offset as given,
+  // before the preferred base is added below.
+  const uint64_t IndexOffset = ModuleOffset;
+  SymbolizationIndex *Index = nullptr;
+  if (!Opts.IndexDirectory.empty()) {
+    if (auto IndexOrErr = getOrCreateIndex(ModuleName))
+      Index = IndexOrErr.get();
+    else
+      return IndexOrErr.takeError();
+    if (Index)
+      if (Optional<DIInliningInfo> Cached = Index->lookup(IndexOffset))
+        return std::move(*Cached);
+  }
+
   SymbolizableModule *Info;
   if (auto InfoOrErr = getOrCreateModuleInfo(ModuleName))
     Info = InfoOrErr.get();
@@ -105,6 +134,10 @@ LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
       Frame->FunctionName = DemangleName(Frame->FunctionName, Info);
     }
   }
+  // Don't persist addresses that couldn't be fully symbolized: a later run
+  // may find the debug info this one is missing.
+  if (Index && isFullySymbolized(InlinedContext))
+    Index->insert(IndexOffset, InlinedContext);
   return InlinedContext;
 }
 
@@ -134,6 +167,11 @@ Expected<DIGlobal> LLVMSymbolizer::symbolizeData(const std::string &ModuleName,
 }
 
 void LLVMSymbolizer::flush() {
+  // The indexes are only a cache, failing to update them is not an error.
+  for (auto &KV : Indexes)
+    if (KV.second)
+      consumeError(KV.second->write());
+  Indexes.clear();
   ObjectForUBPathAndArch.clear();
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
@@ -230,6 +268,36 @@ bool getGNUDebuglinkContents(const ObjectFile *Obj, std::string &DebugName,
   return false;
 }
 
+/// Returns the build ID of \p Obj as a hex string: the UUID of a Mach-O
+/// file, or the GNU build ID note of an ELF file. Returns an empty string if
+/// there is none.
+std::string getBuildIDString(const ObjectFile *Obj) {
+  StringRef BuildID;
+  if (auto MachObj = dyn_cast<const MachOObjectFile>(Obj)) {
+    BuildID = toStringRef(MachObj->getUuid());
+  } else if (isa<ELFObjectFileBase>(Obj)) {
+    for (const SectionRef &Section : Obj->sections()) {
+      StringRef Name;
+      Section.getName(Name);
+      if (Name != ".note.gnu.build-id")
+        continue;
+      StringRef Data;
+      Section.getContents(Data);
+      // The note is made of the name and descriptor sizes, the note type, the
+      // 4-byte aligned "GNU" name, then the build ID itself.
+      DataExtractor DE(Data, Obj->isLittleEndian(), 0);
+      uint32_t Offset = 0;
+      uint32_t NameSize = DE.getU32(&Offset);
+      uint32_t DescSize = DE.getU32(&Offset);
+      Offset += 4 + ((NameSize + 3) & ~0x3);
+      if (DE.isValidOffsetForDataOfSize(Offset, DescSize))
+        BuildID = Data.substr(Offset, DescSize);
+      break;
+    }
+  }
+  return toHex(BuildID);
+}
+
 bool darwinDsymMatchesBinary(const MachOObjectFile *DbgObj,
                              const MachOObjectFile *Obj) {
   ArrayRef<uint8_t> dbg_uuid = DbgObj->getUuid();
@@ -239,6 +307,20 @@ bool darwinDsymMatchesBinary(const MachOObjectFile *DbgObj,
   return !memcmp(dbg_uuid.data(), bin_uuid.data(), dbg_uuid.size());
 }
 
+/// Splits "path/to/binary:arch" into the binary name and the architecture,
+/// or returns \p DefaultArch if there is no valid architecture suffix.
+std::pair<std::string, std::string>
+splitModuleName(const std::string &ModuleName, const std::string &DefaultArch) {
+  size_t ColonPos = ModuleName.find_last_of(':');
+  // Verify that substring after colon form a valid arch name.
+  if (ColonPos != std::string::npos) {
+    std::string ArchStr = ModuleName.substr(ColonPos + 1);
+    if (Triple(ArchStr).getArch() != Triple::UnknownArch)
+      return std::make_pair(ModuleName.substr(0, ColonPos), ArchStr);
+  }
+  return std::make_pair(ModuleName, DefaultArch);
+}
+
 } // end anonymous namespace
 
 ObjectFile *LLVMSymbolizer::lookUpDsymFile(const std::string &ExePath,
@@ -363,23 +445,51 @@ LLVMSymbolizer::getOrCreateObject(const std::string &Path,
   return errorCodeToError(object_error::arch_not_found);
 }
 
+Expected<SymbolizationIndex *>
+LLVMSymbolizer::getOrCreateIndex(const std::string &ModuleName) {
+  const auto &I = Indexes.find(ModuleName);
+  if (I != Indexes.end())
+    return I->second.get();
+  std::unique_ptr<SymbolizationIndex> &Index = Indexes[ModuleName];
+
+  std::string BinaryName, ArchName;
+  std::tie(BinaryName, ArchName) =
+      splitModuleName(ModuleName, Opts.DefaultArch);
+  auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
+  if (!ObjectsOrErr) {
+    // Record the failure for getOrCreateModuleInfo() so that it is reported
+    // only once.
+    Modules.insert(
+        std::make_pair(ModuleName, std::unique_ptr<SymbolizableModule>()));
+    return ObjectsOrErr.takeError();
+  }
+  const ObjectFile *Obj = ObjectsOrErr->first;
+  if (!Obj)
+    return nullptr;
+  std::string BuildID = getBuildIDString(Obj);
+  if (BuildID.empty())
+    return nullptr;
+
+  // The results depend on these options, an index written with different
+  // ones is ignored.
+  uint32_t Flags = static_cast<uint32_t>(Opts.PrintFunctions) |
+                   Opts.UseSymbolTable << 8 | Opts.Demangle << 9 |
+                   Opts.RelativeAddresses << 10;
+  SmallString<128> Path(Opts.IndexDirectory);
+  sys::path::append(Path, BuildID + ".symidx");
+  Index = llvm::make_unique<SymbolizationIndex>(Path.str(), Flags);
+  return Index.get();
+}
+
 Expected<SymbolizableModule *>
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   const auto &I = Modules.find(ModuleName);
   if (I != Modules.end()) {
     return I->second.get();
   }
-  std::string BinaryName = ModuleName;
-  std::string ArchName = Opts.DefaultArch;
-  size_t ColonPos = ModuleName.find_last_of(':');
-  // Verify that substring after colon form a valid arch name.
-  if (ColonPos != std::string::npos) {
-    std::string ArchStr = ModuleName.substr(ColonPos + 1);
-    if (Triple(ArchStr).getArch() != Triple::UnknownArch) {
-      BinaryName = ModuleName.substr(0, ColonPos);
-      ArchName = ArchStr;
-    }
-  }
+  std::string BinaryName, ArchName;
+  std::tie(BinaryName, ArchName) =
+      splitModuleName(ModuleName, Opts.DefaultArch);
   auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
   if (!ObjectsOrErr) {
     // Failed to find valid object file.
@@ -19,9 +19,11 @@
 #include "RuntimeDyldMachO.h"
 #include "llvm/Object/COFF.h"
 #include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 using namespace llvm::object;
@@ -134,15 +136,17 @@ void RuntimeDyldImpl::resolveRelocations() {
   }
 
   // Iterate over all outstanding relocations
-  for (auto it = Relocations.begin(), e = Relocations.end(); it != e; ++it) {
-    // The Section here (Sections[i]) refers to the section in which the
-    // symbol for the relocation is located.  The SectionID in the relocation
-    // entry provides the section to which the relocation will be applied.
-    int Idx = it->first;
-    uint64_t Addr = Sections[Idx].getLoadAddress();
-    DEBUG(dbgs() << "Resolving relocations Section #" << Idx << "\t"
-                 << format("%p", (uintptr_t)Addr) << "\n");
-    resolveRelocationList(it->second, Addr);
+  if (!resolveRelocationsConcurrently()) {
+    for (auto it = Relocations.begin(), e = Relocations.end(); it != e; ++it) {
+      // The Section here (Sections[i]) refers to the section in which the
+      // symbol for the relocation is located.  The SectionID in the relocation
+      // entry provides the section to which the relocation will be applied.
+      int Idx = it->first;
+      uint64_t Addr = Sections[Idx].getLoadAddress();
+      DEBUG(dbgs() << "Resolving relocations Section #" << Idx << "\t"
+                   << format("%p", (uintptr_t)Addr) << "\n");
+      resolveRelocationList(it->second, Addr);
+    }
   }
   Relocations.clear();
 
@@ -157,13 +161,18 @@ void RuntimeDyldImpl::resolveRelocations() {
 void RuntimeDyldImpl::mapSectionAddress(const void *LocalAddress,
                                         uint64_t TargetAddress) {
   MutexGuard locked(lock);
-  for (unsigned i = 0, e = Sections.size(); i != e; ++i) {
-    if (Sections[i].getAddress() == LocalAddress) {
-      reassignSectionAddress(i, TargetAddress);
-      return;
-    }
-  }
-  llvm_unreachable("Attempting to remap address of unknown section!");
+  // The address of a section's local copy doesn't change once its object is
+  // loaded, so index the sections added since the last call. If two sections
+  // share an address, the first one is remapped.
+  for (unsigned e = Sections.size(); NumIndexedSections != e;
+       ++NumIndexedSections)
+    if (const void *Addr = Sections[NumIndexedSections].getAddress())
+      SectionIDsByAddress.insert(std::make_pair(Addr, NumIndexedSections));
+
+  auto I = SectionIDsByAddress.find(LocalAddress);
+  if (I == SectionIDsByAddress.end())
+    llvm_unreachable("Attempting to remap address of unknown section!");
+  reassignSectionAddress(I->second, TargetAddress);
 }
 
 static Error getOffset(const SymbolRef &Sym, SectionRef Sec,
@@ -958,18 +967,68 @@ void RuntimeDyldImpl::resolveRelocationList(const RelocationList &Relocs,
   }
 }
 
+// The number of relocations below which resolving them on several threads
+// costs more than it saves.
+static cl::opt<unsigned> ConcurrentRelocationThreshold(
+    "rtdyld-concurrent-relocation-threshold", cl::Hidden, cl::init(1 << 14),
+    cl::desc("Resolve the relocations of different sections concurrently "
+             "when there are at least this many of them"));
+
+bool RuntimeDyldImpl::resolveRelocationsConcurrently() {
+  if (!canResolveRelocationsConcurrently())
+    return false;
+  size_t NumRelocations = 0;
+  for (const auto &Entry : Relocations)
+    NumRelocations += Entry.second.size();
+  bool Concurrent = NumRelocations >= ConcurrentRelocationThreshold;
+  // Keep the debug output of the relocations in order.
+  DEBUG(Concurrent = false);
+  if (!Concurrent)
+    return false;
+
+  // Group the relocations by the section they are applied to, so that every
+  // section is only written by one thread. Within a section the relocations
+  // are applied in the same order as by the serial loop.
+  typedef std::pair<const RelocationEntry *, uint64_t> RelocationAndValue;
+  std::vector<std::vector<RelocationAndValue>> RelocationsBySection(
+      Sections.size());
+  for (const auto &Entry : Relocations) {
+    uint64_t Addr = Sections[Entry.first].getLoadAddress();
+    for (const RelocationEntry &RE : Entry.second)
+      // Ignore relocations for sections that were not loaded
+      if (Sections[RE.SectionID].getAddress() != nullptr)
+        RelocationsBySection[RE.SectionID].push_back(std::make_pair(&RE, Addr));
+  }
+
+  parallel::for_each_n(
+      parallel::par, size_t(0), RelocationsBySection.size(), [&](size_t I) {
+        for (const RelocationAndValue &R : RelocationsBySection[I])
+          resolveRelocation(*R.first, R.second);
+      });
+  return true;
+}
+
 Error RuntimeDyldImpl::resolveExternalSymbols() {
+  // Look up the addresses of all the outstanding symbols first, then apply
+  // their relocations. Taking the symbols one at a time from the front of the
+  // map would rescan its already emptied buckets on every step. Looking up a
+  // symbol may cause additional modules to be loaded, which may add new
+  // symbols or relocations to the ExternalSymbolRelocations map, so the lists
+  // are only retrieved once all the lookups of this round are done, and new
+  // symbols are handled by the next round.
   while (!ExternalSymbolRelocations.empty()) {
-    StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin();
-
-    StringRef Name = i->first();
-    if (Name.size() == 0) {
+    // The keys of the map stay valid until their entry is erased.
+    std::vector<std::pair<StringRef, uint64_t>> Symbols;
+    Symbols.reserve(ExternalSymbolRelocations.size());
+    for (const auto &Entry : ExternalSymbolRelocations)
+      Symbols.push_back(std::make_pair(Entry.first(), uint64_t(0)));
+
+    for (auto &Symbol : Symbols) {
+      StringRef Name = Symbol.first;
       // This is an absolute symbol, use an address of zero.
-      DEBUG(dbgs() << "Resolving absolute relocations."
-                   << "\n");
-      RelocationList &Relocs = i->second;
-      resolveRelocationList(Relocs, 0);
-    } else {
+      if (Name.size() == 0)
+        continue;
+
       uint64_t Addr = 0;
       RTDyldSymbolTable::const_iterator Loc = GlobalSymbolTable.find(Name);
       if (Loc == GlobalSymbolTable.end()) {
@@ -994,13 +1053,6 @@ Error RuntimeDyldImpl::resolveExternalSymbols() {
           } else if (auto Err = Sym.takeError())
             return Err;
         }
-        // The call to getSymbolAddress may have caused additional modules to
-        // be loaded, which may have added new entries to the
-        // ExternalSymbolRelocations map.  Consquently, we need to update our
-        // iterator.  This is also why retrieval of the relocation list
-        // associated with this symbol is deferred until below this point.
-        // New entries may have been added to the relocation list.
-        i = ExternalSymbolRelocations.find(Name);
       } else {
         // We found the symbol in our global table.  It was probably in a
         // Module that we loaded previously.
@@ -1013,20 +1065,27 @@ Error RuntimeDyldImpl::resolveExternalSymbols() {
       if (!Addr)
         report_fatal_error("Program used external function '" + Name +
                            "' which could not be resolved!");
+      Symbol.second = Addr;
+    }
 
-      // If Resolver returned UINT64_MAX, the client wants to handle this symbol
-      // manually and we shouldn't resolve its relocations.
-      if (Addr != UINT64_MAX) {
+    for (const auto &Symbol : Symbols) {
+      StringRef Name = Symbol.first;
+      uint64_t Addr = Symbol.second;
+      StringMap<RelocationList>::iterator i =
+          ExternalSymbolRelocations.find(Name);
+      if (Name.size() == 0) {
+        DEBUG(dbgs() << "Resolving absolute relocations."
+                     << "\n");
+        resolveRelocationList(i->second, 0);
+      } else if (Addr != UINT64_MAX) {
+        // If Resolver returned UINT64_MAX, the client wants to handle this
+        // symbol manually and we shouldn't resolve its relocations.
         DEBUG(dbgs() << "Resolving relocations Name: " << Name << "\t"
                      << format("0x%lx", Addr) << "\n");
-        // This list may have been updated when we called getSymbolAddress, so
-        // don't change this code to get the list earlier.
-        RelocationList &Relocs = i->second;
-        resolveRelocationList(Relocs, Addr);
+        resolveRelocationList(i->second, Addr);
       }
+      ExternalSymbolRelocations.erase(i);
     }
-
-    ExternalSymbolRelocations.erase(i);
   }
 
   return Error::success();
@@ -14,6 +14,7 @@
 #ifndef LLVM_LIB_EXECUTIONENGINE_RUNTIMEDYLD_RUNTIMEDYLDIMPL_H
 #define LLVM_LIB_EXECUTIONENGINE_RUNTIMEDYLD_RUNTIMEDYLDIMPL_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
@@ -255,6 +256,11 @@ protected:
   typedef SmallVector<SectionEntry, 64> SectionList;
   SectionList Sections;
 
+  // The SectionIDs of the sections by the address of their local copy, used
+  // by mapSectionAddress. Sections[0, NumIndexedSections) have been indexed.
+  DenseMap<const void *, unsigned> SectionIDsByAddress;
+  unsigned NumIndexedSections = 0;
+
   typedef unsigned SID; // Type for SectionIDs
 #define RTDYLD_INVALID_SECTION_ID ((RuntimeDyldImpl::SID)(-1))
 
@@ -402,6 +408,17 @@ protected:
   /// \brief Resolves relocations from Relocs list with address from Value.
   void resolveRelocationList(const RelocationList &Relocs, uint64_t Value);
 
+  /// \brief Resolves the relocations of the Relocations map, applying the
+  ///        relocations of each section on a different thread when there are
+  ///        enough of them.
+  /// \return false if the relocations must be resolved serially instead.
+  bool resolveRelocationsConcurrently();
+
+  /// \brief Returns true if resolveRelocation only writes to the section the
+  ///        relocation applies to, so that the relocations of different
+  ///        sections can be resolved at the same time.
+  virtual bool canResolveRelocationsConcurrently() const { return false; }
+
   /// \brief A object file specific relocation resolver
   /// \param RE The relocation to be resolved
   /// \param Value Target symbol address to apply the relocation action
@@ -27,6 +27,9 @@ public:
       : RuntimeDyldELF(MM, Resolver) {}
 
   void resolveRelocation(const RelocationEntry &RE, uint64_t Value) override;
+  // Relocations through the GOT also fill in the GOT entries of the section
+  // (and may add it to SectionToGOTMap), so they are resolved one at a time.
+  bool canResolveRelocationsConcurrently() const override { return false; }
 
 protected:
   void resolveMIPSO32Relocation(const SectionEntry &Section, uint64_t Offset,
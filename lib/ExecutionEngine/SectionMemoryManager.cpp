@@ -14,8 +14,11 @@
 
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Config/config.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Process.h"
+#include <algorithm>
+#include <tuple>
 
 namespace llvm {
 
@@ -25,25 +28,40 @@ uint8_t *SectionMemoryManager::allocateDataSection(uintptr_t Size,
                                                    StringRef SectionName,
                                                    bool IsReadOnly) {
   if (IsReadOnly)
-    return allocateSection(RODataMem, Size, Alignment);
-  return allocateSection(RWDataMem, Size, Alignment);
+    return allocateSection(SectionMemoryManager::AllocationPurpose::ROData,
+                           Size, Alignment);
+  return allocateSection(SectionMemoryManager::AllocationPurpose::RWData, Size,
+                         Alignment);
 }
 
 uint8_t *SectionMemoryManager::allocateCodeSection(uintptr_t Size,
                                                    unsigned Alignment,
                                                    unsigned SectionID,
                                                    StringRef SectionName) {
-  return allocateSection(CodeMem, Size, Alignment);
+  return allocateSection(SectionMemoryManager::AllocationPurpose::Code, Size,
+                         Alignment);
 }
 
-uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
-                                               uintptr_t Size,
-                                               unsigned Alignment) {
+uint8_t *SectionMemoryManager::allocateSection(
+    SectionMemoryManager::AllocationPurpose Purpose, uintptr_t Size,
+    unsigned Alignment) {
   if (!Alignment)
     Alignment = 16;
 
   assert(!(Alignment & (Alignment - 1)) && "Alignment must be a power of two.");
 
+  MemoryGroup &MemGroup = [&]() -> MemoryGroup & {
+    switch (Purpose) {
+    case AllocationPurpose::Code:
+      return CodeMem;
+    case AllocationPurpose::ROData:
+      return RODataMem;
+    case AllocationPurpose::RWData:
+      return RWDataMem;
+    }
+    llvm_unreachable("Unknown SectionMemoryManager::AllocationPurpose");
+  }();
+
   uintptr_t RequiredSize = Alignment * ((Size + Alignment - 1)/Alignment + 1);
   uintptr_t Addr = 0;
 
@@ -84,11 +102,9 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   // FIXME: Initialize the Near member for each memory group to avoid
   // interleaving.
   std::error_code ec;
-  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
-                                                          &MemGroup.Near,
-                                                          sys::Memory::MF_READ |
-                                                            sys::Memory::MF_WRITE,
-                                                          ec);
+  sys::MemoryBlock MB = MMapper.allocateMappedMemory(
+      Purpose, RequiredSize, &MemGroup.Near,
+      sys::Memory::MF_READ | sys::Memory::MF_WRITE, ec);
   if (ec) {
     // FIXME: Add error propagation to the interface.
     return nullptr;
@@ -181,7 +197,7 @@ std::error_code
 SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                                   unsigned Permissions) {
   for (sys::MemoryBlock &MB : MemGroup.PendingMem)
-    if (std::error_code EC = sys::Memory::protectMappedMemory(MB, Permissions))
+    if (std::error_code EC = MMapper.protectMappedMemory(MB, Permissions))
       return EC;
 
   MemGroup.PendingMem.clear();
@@ -211,8 +227,132 @@ void SectionMemoryManager::invalidateInstructionCache() {
 SectionMemoryManager::~SectionMemoryManager() {
   for (MemoryGroup *Group : {&CodeMem, &RWDataMem, &RODataMem}) {
     for (sys::MemoryBlock &Block : Group->AllocatedMem)
-      sys::Memory::releaseMappedMemory(Block);
+      MMapper.releaseMappedMemory(Block);
+  }
+}
+
+SectionMemoryManager::MemoryMapper::~MemoryMapper() {}
+
+namespace {
+// Trivial implementation of SectionMemoryManager::MemoryMapper that just calls
+// into sys::Memory.
+class DefaultMMapper final : public SectionMemoryManager::MemoryMapper {
+public:
+  sys::MemoryBlock
+  allocateMappedMemory(SectionMemoryManager::AllocationPurpose Purpose,
+                       size_t NumBytes, const sys::MemoryBlock *const NearBlock,
+                       unsigned Flags, std::error_code &EC) override {
+    return sys::Memory::allocateMappedMemory(NumBytes, NearBlock, Flags, EC);
+  }
+
+  std::error_code protectMappedMemory(const sys::MemoryBlock &Block,
+                                      unsigned Flags) override {
+    return sys::Memory::protectMappedMemory(Block, Flags);
+  }
+
+  std::error_code releaseMappedMemory(sys::MemoryBlock &M) override {
+    return sys::Memory::releaseMappedMemory(M);
   }
+};
+
+ManagedStatic<DefaultMMapper> DefaultMMapperInstance;
+} // namespace
+
+SectionMemoryManager::SectionMemoryManager(MemoryMapper *MM)
+    : MMapper(MM ? *MM : *DefaultMMapperInstance) {}
+
+RecyclingMemoryMapper::RecyclingMemoryMapper(size_t MaxCachedBytes,
+                                             size_t MaxSlabSize)
+    : MaxCachedBytes(MaxCachedBytes), MaxSlabSize(MaxSlabSize),
+      PageSize(sys::Process::getPageSize()) {}
+
+RecyclingMemoryMapper::~RecyclingMemoryMapper() {
+  assert(LiveSlabs.empty() && "Memory managers must be destroyed first");
+  for (auto &Slabs : FreeSlabs)
+    for (auto &Entry : Slabs)
+      sys::Memory::releaseMappedMemory(Entry.first);
+}
+
+sys::MemoryBlock RecyclingMemoryMapper::allocateMappedMemory(
+    SectionMemoryManager::AllocationPurpose Purpose, size_t NumBytes,
+    const sys::MemoryBlock *const NearBlock, unsigned Flags,
+    std::error_code &EC) {
+  EC = std::error_code();
+  size_t NumPages = std::max<size_t>(1, alignTo(NumBytes, PageSize) / PageSize);
+  unsigned SizeClass = Log2_64_Ceil(NumPages);
+  size_t SlabSize = PageSize << SizeClass;
+  if (SlabSize > MaxSlabSize)
+    return sys::Memory::allocateMappedMemory(NumBytes, NearBlock, Flags, EC);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (SizeClass < FreeSlabs.size() && !FreeSlabs[SizeClass].empty()) {
+    sys::MemoryBlock MB;
+    unsigned OldFlags;
+    std::tie(MB, OldFlags) = FreeSlabs[SizeClass].back();
+    FreeSlabs[SizeClass].pop_back();
+    CachedBytes -= MB.size();
+    if (OldFlags != Flags) {
+      if ((EC = sys::Memory::protectMappedMemory(MB, Flags))) {
+        sys::Memory::releaseMappedMemory(MB);
+        return sys::MemoryBlock();
+      }
+    }
+    LiveSlabs[(uintptr_t)MB.base()] = {MB.size(), Flags};
+    return MB;
+  }
+
+  // Map a whole slab. The memory manager puts the rest of it on its free list.
+  sys::MemoryBlock MB =
+      sys::Memory::allocateMappedMemory(SlabSize, NearBlock, Flags, EC);
+  if (!EC)
+    LiveSlabs[(uintptr_t)MB.base()] = {MB.size(), Flags};
+  return MB;
+}
+
+std::error_code
+RecyclingMemoryMapper::protectMappedMemory(const sys::MemoryBlock &Block,
+                                           unsigned Flags) {
+  if (std::error_code EC = sys::Memory::protectMappedMemory(Block, Flags))
+    return EC;
+
+  // Remember if the slab holding Block no longer has uniform permissions.
+  std::lock_guard<std::mutex> Lock(Mutex);
+  uintptr_t Addr = (uintptr_t)Block.base();
+  auto It = LiveSlabs.upper_bound(Addr);
+  if (It == LiveSlabs.begin())
+    return std::error_code();
+  --It;
+  Slab &S = It->second;
+  if (Addr < It->first + S.Size && S.Flags != Flags)
+    S.Flags = Addr == It->first && Block.size() >= S.Size ? Flags : ~0U;
+  return std::error_code();
+}
+
+std::error_code
+RecyclingMemoryMapper::releaseMappedMemory(sys::MemoryBlock &M) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = LiveSlabs.find((uintptr_t)M.base());
+    if (It != LiveSlabs.end()) {
+      unsigned Flags = It->second.Flags;
+      LiveSlabs.erase(It);
+      if (CachedBytes + M.size() <= MaxCachedBytes) {
+        unsigned SizeClass = Log2_64(M.size() / PageSize);
+        if (FreeSlabs.size() <= SizeClass)
+          FreeSlabs.resize(SizeClass + 1);
+        FreeSlabs[SizeClass].push_back(std::make_pair(M, Flags));
+        CachedBytes += M.size();
+        M = sys::MemoryBlock();
+        return std::error_code();
+      }
+    }
+  }
+  return sys::Memory::releaseMappedMemory(M);
+}
+
+size_t RecyclingMemoryMapper::getCachedBytes() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return CachedBytes;
 }
 
 } // namespace llvm
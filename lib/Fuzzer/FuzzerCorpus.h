@@ -18,7 +18,6 @@
 #include "FuzzerSHA1.h"
 #include "FuzzerTracePC.h"
 #include <algorithm>
-#include <numeric>
 #include <random>
 #include <unordered_set>
 
@@ -84,7 +83,7 @@ class InputCorpus {
     std::sort(II.UniqFeatureSet.begin(), II.UniqFeatureSet.end());
     ComputeSHA1(U.data(), U.size(), II.Sha1);
     Hashes.insert(Sha1ToString(II.Sha1));
-    UpdateCorpusDistribution();
+    AppendInputWeight(ComputeInputWeight(Inputs.size() - 1));
     PrintCorpus();
     // ValidateFeatureSet();
   }
@@ -148,7 +147,12 @@ class InputCorpus {
   // Hypothesis: units added to the corpus last are more likely to be
   // interesting. This function gives more weight to the more recent units.
   size_t ChooseUnitIdxToMutate(Random &Rand) {
-    size_t Idx = static_cast<size_t>(CorpusDistribution(Rand));
+    assert(!Inputs.empty());
+    if (!TotalWeight)
+      return Rand(Inputs.size());
+    uint64_t Target =
+        std::uniform_int_distribution<uint64_t>(0, TotalWeight - 1)(Rand);
+    size_t Idx = FindWeightIndex(Target);
     assert(Idx < Inputs.size());
     return Idx;
   }
@@ -197,6 +201,7 @@ class InputCorpus {
         InputInfo &II = *Inputs[OldIdx];
         assert(II.NumFeatures > 0);
         II.NumFeatures--;
+        SetInputWeight(OldIdx, ComputeInputWeight(OldIdx));
         if (II.NumFeatures == 0)
           DeleteInput(OldIdx);
       } else {
@@ -241,23 +246,61 @@ private:
     }
   }
 
-  // Updates the probability distribution for the units in the corpus.
-  // Must be called whenever the corpus or unit weights are changed.
-  void UpdateCorpusDistribution() {
-    size_t N = Inputs.size();
-    assert(N);
-    Intervals.resize(N + 1);
-    Weights.resize(N);
-    std::iota(Intervals.begin(), Intervals.end(), 0);
-    for (size_t i = 0; i < N; i++)
-      Weights[i] = Inputs[i]->NumFeatures * (i + 1);
-    CorpusDistribution = std::piecewise_constant_distribution<double>(
-        Intervals.begin(), Intervals.end(), Weights.begin());
+  // The probability of choosing a unit is proportional to its weight.
+  // The weights are kept in a Fenwick tree, so adding a unit or changing the
+  // weight of one is O(log N) instead of rebuilding the whole distribution.
+  // AddToCorpus and AddFeature keep the weights up to date.
+  uint64_t ComputeInputWeight(size_t Idx) const {
+    return static_cast<uint64_t>(Inputs[Idx]->NumFeatures) * (Idx + 1);
   }
-  std::piecewise_constant_distribution<double> CorpusDistribution;
 
-  std::vector<double> Intervals;
-  std::vector<double> Weights;
+  static size_t LowBit(size_t N) { return N & (~N + 1); }
+
+  // Returns the sum of the weights of the first N units.
+  uint64_t WeightPrefixSum(size_t N) const {
+    uint64_t Res = 0;
+    for (; N; N &= N - 1)
+      Res += WeightTree[N - 1];
+    return Res;
+  }
+
+  void AppendInputWeight(uint64_t Weight) {
+    // Node N covers the units in (N - LowBit(N), N].
+    size_t N = WeightTree.size() + 1;
+    WeightTree.push_back(Weight + WeightPrefixSum(N - 1) -
+                         WeightPrefixSum(N - LowBit(N)));
+    Weights.push_back(Weight);
+    TotalWeight += Weight;
+  }
+
+  void SetInputWeight(size_t Idx, uint64_t Weight) {
+    uint64_t OldWeight = Weights[Idx];
+    Weights[Idx] = Weight;
+    TotalWeight = TotalWeight - OldWeight + Weight;
+    for (size_t N = Idx + 1; N <= WeightTree.size(); N += LowBit(N))
+      WeightTree[N - 1] = WeightTree[N - 1] - OldWeight + Weight;
+  }
+
+  // Returns the unit whose weight range contains Target, that is the
+  // smallest Idx such that Target < WeightPrefixSum(Idx + 1).
+  size_t FindWeightIndex(uint64_t Target) const {
+    size_t Pos = 0;
+    size_t Mask = 1;
+    while (Mask * 2 <= WeightTree.size())
+      Mask *= 2;
+    for (; Mask; Mask /= 2) {
+      if (Pos + Mask <= WeightTree.size() &&
+          WeightTree[Pos + Mask - 1] <= Target) {
+        Pos += Mask;
+        Target -= WeightTree[Pos - 1];
+      }
+    }
+    return Pos;
+  }
+
+  std::vector<uint64_t> Weights;
+  std::vector<uint64_t> WeightTree;
+  uint64_t TotalWeight = 0;
 
   std::unordered_set<std::string> Hashes;
   std::vector<InputInfo*> Inputs;
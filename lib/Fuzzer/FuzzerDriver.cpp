@@ -708,7 +708,8 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
     else
       F->CrashResistantMerge(Args, *Inputs,
                              Flags.load_coverage_summary,
-                             Flags.save_coverage_summary);
+                             Flags.save_coverage_summary,
+                             Flags.merge_workers);
     exit(0);
   }
 
@@ -68,8 +68,9 @@ void WriteToFile(const Unit &U, const std::string &Path) {
   fclose(Out);
 }
 
-void ReadDirToVectorOfUnits(const char *Path, std::vector<Unit> *V,
-                            long *Epoch, size_t MaxSize, bool ExitOnError) {
+void ReadDirToVectorOfUnits(
+    const char *Path, std::vector<Unit> *V, long *Epoch, size_t MaxSize,
+    bool ExitOnError, const std::function<bool(const std::string &)> &Skip) {
   long E = Epoch ? *Epoch : 0;
   std::vector<std::string> Files;
   ListFilesInDirRecursive(Path, Epoch, &Files, /*TopDir*/true);
@@ -77,6 +78,7 @@ void ReadDirToVectorOfUnits(const char *Path, std::vector<Unit> *V,
   for (size_t i = 0; i < Files.size(); i++) {
     auto &X = Files[i];
     if (Epoch && GetEpoch(X) < E) continue;
+    if (Skip && Skip(X)) continue;
     NumLoaded++;
     if ((NumLoaded & (NumLoaded - 1)) == 0 && NumLoaded >= 1024)
       Printf("Loaded %zd/%zd files from %s\n", NumLoaded, Files.size(), Path);
@@ -13,6 +13,7 @@
 #define LLVM_FUZZER_IO_H
 
 #include "FuzzerDefs.h"
+#include <functional>
 
 namespace fuzzer {
 
@@ -27,8 +28,13 @@ void CopyFileToErr(const std::string &Path);
 
 void WriteToFile(const Unit &U, const std::string &Path);
 
-void ReadDirToVectorOfUnits(const char *Path, std::vector<Unit> *V,
-                            long *Epoch, size_t MaxSize, bool ExitOnError);
+// Reads the files of Path, and of its subdirs, into V. If Epoch is given only
+// the files modified since then are read, and Epoch is updated. Files for
+// which Skip returns true are not read.
+void ReadDirToVectorOfUnits(
+    const char *Path, std::vector<Unit> *V, long *Epoch, size_t MaxSize,
+    bool ExitOnError,
+    const std::function<bool(const std::string &)> &Skip = nullptr);
 
 // Returns "Dir/FileName" or equivalent for the current OS.
 std::string DirPlusFile(const std::string &DirPath,
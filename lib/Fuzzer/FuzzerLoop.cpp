@@ -352,10 +352,19 @@ void Fuzzer::CheckExitOnSrcPosOrItem() {
 
 void Fuzzer::RereadOutputCorpus(size_t MaxSize) {
   if (Options.OutputCorpus.empty() || !Options.ReloadIntervalSec) return;
+  // Units in the output corpus are named after their hash. The ones this
+  // process wrote, or already loaded from other workers, are in the corpus and
+  // are skipped without reading them. Epochs have a granularity of a second,
+  // so otherwise every file written during the last second would be read and
+  // hashed again at each reload.
   std::vector<Unit> AdditionalCorpus;
-  ReadDirToVectorOfUnits(Options.OutputCorpus.c_str(), &AdditionalCorpus,
-                         &EpochOfLastReadOfOutputCorpus, MaxSize,
-                         /*ExitOnError*/ false);
+  ReadDirToVectorOfUnits(
+      Options.OutputCorpus.c_str(), &AdditionalCorpus,
+      &EpochOfLastReadOfOutputCorpus, MaxSize,
+      /*ExitOnError*/ false, [&](const std::string &Path) {
+        auto Name = Path.substr(Path.find_last_of(GetSeparator()) + 1);
+        return Corpus.HasUnit(Name);
+      });
   if (Options.Verbosity >= 2)
     Printf("Reload: read %zd new units.\n", AdditionalCorpus.size());
   bool Reloaded = false;
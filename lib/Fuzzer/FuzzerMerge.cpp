@@ -19,6 +19,7 @@
 #include <iterator>
 #include <set>
 #include <sstream>
+#include <thread>
 
 namespace fuzzer {
 
@@ -251,11 +252,41 @@ void Fuzzer::CrashResistantMergeInternalStep(const std::string &CFPath) {
   }
 }
 
+static void WriteMergeControlFile(const std::string &CFPath,
+                                  const std::vector<std::string> &Files,
+                                  size_t NumFilesInFirstCorpus) {
+  RemoveFile(CFPath);
+  std::ofstream ControlFile(CFPath);
+  ControlFile << Files.size() << "\n";
+  ControlFile << NumFilesInFirstCorpus << "\n";
+  for (auto &Path: Files)
+    ControlFile << Path << "\n";
+  if (!ControlFile) {
+    Printf("MERGE-OUTER: failed to write to the control file: %s\n",
+           CFPath.c_str());
+    exit(1);
+  }
+}
+
+// Executes the inner process untill it passes. Every inner process should
+// execute at least one input, so there are at most NumFiles attempts.
+// Returns the number of attempts, or 0 if none of them succeeded.
+static size_t RunMergeInnerProcess(const std::string &Cmd, size_t NumFiles,
+                                   const std::string &ShardName) {
+  for (size_t i = 1; i <= NumFiles; i++) {
+    Printf("MERGE-OUTER: %sattempt %zd\n", ShardName.c_str(), i);
+    if (!ExecuteCommand(Cmd))
+      return i;
+  }
+  return 0;
+}
+
 // Outer process. Does not call the target code and thus sohuld not fail.
 void Fuzzer::CrashResistantMerge(const std::vector<std::string> &Args,
                                  const std::vector<std::string> &Corpora,
                                  const char *CoverageSummaryInputPathOrNull,
-                                 const char *CoverageSummaryOutputPathOrNull) {
+                                 const char *CoverageSummaryOutputPathOrNull,
+                                 size_t NumWorkers) {
   if (Corpora.size() <= 1) {
     Printf("Merge requires two or more corpus dirs\n");
     return;
@@ -267,49 +298,84 @@ void Fuzzer::CrashResistantMerge(const std::vector<std::string> &Args,
     ListFilesInDirRecursive(Corpora[i], nullptr, &AllFiles, /*TopDir*/true);
   Printf("MERGE-OUTER: %zd files, %zd in the initial corpus\n",
          AllFiles.size(), NumFilesInFirstCorpus);
-  auto CFPath = DirPlusFile(TmpDir(),
-                       "libFuzzerTemp." + std::to_string(GetPid()) + ".txt");
-  // Write the control file.
-  RemoveFile(CFPath);
-  std::ofstream ControlFile(CFPath);
-  ControlFile << AllFiles.size() << "\n";
-  ControlFile << NumFilesInFirstCorpus << "\n";
-  for (auto &Path: AllFiles)
-    ControlFile << Path << "\n";
-  if (!ControlFile) {
-    Printf("MERGE-OUTER: failed to write to the control file: %s\n",
-           CFPath.c_str());
-    exit(1);
+
+  // Shard the files round-robin. Every shard keeps the files in their
+  // original order, so the files of the first corpus stay at its front.
+  size_t NumShards =
+      std::max<size_t>(1, std::min<size_t>(NumWorkers, AllFiles.size()));
+  if (NumShards > 1)
+    Printf("MERGE-OUTER: %zd shards\n", NumShards);
+  std::vector<std::vector<size_t>> ShardFileIds(NumShards);
+  for (size_t i = 0; i < AllFiles.size(); i++)
+    ShardFileIds[i % NumShards].push_back(i);
+
+  std::vector<std::string> CFPaths(NumShards);
+  for (size_t S = 0; S < NumShards; S++) {
+    std::string Suffix = NumShards > 1 ? "." + std::to_string(S) : "";
+    CFPaths[S] = DirPlusFile(TmpDir(), "libFuzzerTemp." +
+                                           std::to_string(GetPid()) + Suffix +
+                                           ".txt");
+    std::vector<std::string> Files;
+    size_t NumFirst = 0;
+    for (size_t Id : ShardFileIds[S]) {
+      Files.push_back(AllFiles[Id]);
+      NumFirst += Id < NumFilesInFirstCorpus;
+    }
+    // Write the control file.
+    WriteMergeControlFile(CFPaths[S], Files, NumFirst);
   }
-  ControlFile.close();
 
-  // Execute the inner process untill it passes.
-  // Every inner process should execute at least one input.
   auto BaseCmd = SplitBefore("-ignore_remaining_args=1",
                              CloneArgsWithoutX(Args, "keep-all-flags"));
-  bool Success = false;
-  for (size_t i = 1; i <= AllFiles.size(); i++) {
-    Printf("MERGE-OUTER: attempt %zd\n", i);
-    auto ExitCode = ExecuteCommand(BaseCmd.first + " -merge_control_file=" +
-                                   CFPath + " " + BaseCmd.second);
-    if (!ExitCode) {
-      Printf("MERGE-OUTER: succesfull in %zd attempt(s)\n", i);
-      Success = true;
-      break;
-    }
+  std::vector<size_t> Attempts(NumShards);
+  auto RunShard = [&](size_t S) {
+    std::string ShardName =
+        NumShards > 1 ? "shard " + std::to_string(S) + ": " : "";
+    Attempts[S] = RunMergeInnerProcess(BaseCmd.first + " -merge_control_file=" +
+                                           CFPaths[S] + " " + BaseCmd.second,
+                                       ShardFileIds[S].size(), ShardName);
+  };
+  if (NumShards == 1) {
+    RunShard(0);
+  } else {
+    std::vector<std::thread> Threads;
+    for (size_t S = 0; S < NumShards; S++)
+      Threads.push_back(std::thread(RunShard, S));
+    for (auto &T : Threads)
+      T.join();
   }
-  if (!Success) {
-    Printf("MERGE-OUTER: zero succesfull attempts, exiting\n");
-    exit(1);
+  for (size_t S = 0; S < NumShards; S++) {
+    if (!Attempts[S]) {
+      Printf("MERGE-OUTER: zero succesfull attempts, exiting\n");
+      exit(1);
+    }
+    if (NumShards == 1)
+      Printf("MERGE-OUTER: succesfull in %zd attempt(s)\n", Attempts[S]);
+    else
+      Printf("MERGE-OUTER: shard %zd succesfull in %zd attempt(s)\n", S,
+             Attempts[S]);
   }
-  // Read the control file and do the merge.
+
+  // Read the control files and do the merge. The shards are put back in the
+  // original order so that the greedy selection is the same for any number
+  // of workers.
   Merger M;
-  std::ifstream IF(CFPath);
-  IF.seekg(0, IF.end);
-  Printf("MERGE-OUTER: the control file has %zd bytes\n", (size_t)IF.tellg());
-  IF.seekg(0, IF.beg);
-  M.ParseOrExit(IF, true);
-  IF.close();
+  M.Files.resize(AllFiles.size());
+  M.NumFilesInFirstCorpus = NumFilesInFirstCorpus;
+  size_t ControlFileBytes = 0;
+  for (size_t S = 0; S < NumShards; S++) {
+    Merger Shard;
+    std::ifstream IF(CFPaths[S]);
+    IF.seekg(0, IF.end);
+    ControlFileBytes += IF.tellg();
+    IF.seekg(0, IF.beg);
+    Shard.ParseOrExit(IF, true);
+    IF.close();
+    assert(Shard.Files.size() == ShardFileIds[S].size());
+    for (size_t i = 0; i < Shard.Files.size(); i++)
+      M.Files[ShardFileIds[S][i]] = std::move(Shard.Files[i]);
+  }
+  Printf("MERGE-OUTER: the control file has %zd bytes\n", ControlFileBytes);
   Printf("MERGE-OUTER: consumed %zdMb (%zdMb rss) to parse the control file\n",
          M.ApproximateMemoryConsumption() >> 20, GetPeakRSSMb());
   if (CoverageSummaryOutputPathOrNull) {
@@ -331,8 +397,9 @@ void Fuzzer::CrashResistantMerge(const std::vector<std::string> &Args,
          NewFiles.size(), NumNewFeatures);
   for (auto &F: NewFiles)
     WriteToOutputCorpus(FileToVector(F));
-  // We are done, delete the control file.
-  RemoveFile(CFPath);
+  // We are done, delete the control files.
+  for (auto &CFPath : CFPaths)
+    RemoveFile(CFPath);
 }
 
 } // namespace fuzzer
@@ -29,9 +29,15 @@
 //   file will be "STARTED INPUT_ID" and so the next process will know
 //   where to resume.
 //
+//   With -merge_workers=N the outer process shards the inputs round-robin
+//   between N control files and runs an inner process for every shard in
+//   parallel. A shard has the same format as a single control file, so each
+//   one is resumed on its own after a crash.
+//
 //   Once all inputs are processed by the innner process(es) the outer process
 //   reads the control files and does the merge based entirely on the contents
-//   of control file.
+//   of control file. The shards are put back in the original order first, so
+//   the result does not depend on the number of workers.
 //   It uses a single pass greedy algorithm choosing first the smallest inputs
 //   within the same size the inputs that have more new features.
 //
@@ -168,8 +168,26 @@ void ForEachNonZeroByte(const uint8_t *Begin, const uint8_t *End,
     if (uint8_t V = *P)
       Handle8bitCounter(FirstFeature + P - Begin, V);
 
+  // Counters are mostly zero, so skip whole blocks of them with a single
+  // test.
+  const size_t BlockSize = 8 * Step;
+  while (size_t(End - P) >= BlockSize) {
+    auto Block = reinterpret_cast<const LargeType *>(P);
+    LargeType Any = (Block[0] | Block[1] | Block[2] | Block[3]) |
+                    (Block[4] | Block[5] | Block[6] | Block[7]);
+    if (!Any) {
+      P += BlockSize;
+      continue;
+    }
+    for (size_t J = 0; J < 8; J++, P += Step)
+      if (LargeType Bundle = Block[J])
+        for (size_t I = 0; I < Step; I++, Bundle >>= 8)
+          if (uint8_t V = Bundle & 0xff)
+            Handle8bitCounter(FirstFeature + P - Begin + I, V);
+  }
+
   // Iterate by Step bytes at a time.
-  for (; P < End; P += Step)
+  for (; size_t(End - P) >= Step; P += Step)
     if (LargeType Bundle = *reinterpret_cast<const LargeType *>(P))
       for (size_t I = 0; I < Step; I++, Bundle >>= 8)
         if (uint8_t V = Bundle & 0xff)
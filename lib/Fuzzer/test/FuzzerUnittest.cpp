@@ -576,6 +576,26 @@ TEST(Corpus, Distribution) {
   }
 }
 
+TEST(Corpus, DistributionFollowsWeights) {
+  Random Rand(0);
+  std::unique_ptr<InputCorpus> C(new InputCorpus(""));
+  size_t N = 37;
+  size_t TriesPerUnit = 1<<14;
+  // Unit i has weight i + 1.
+  for (size_t i = 0; i < N; i++)
+    C->AddToCorpus(Unit{ static_cast<uint8_t>(i) }, 1, false, {});
+
+  std::vector<size_t> Hist(N);
+  for (size_t i = 0; i < N * TriesPerUnit; i++)
+    Hist[C->ChooseUnitIdxToMutate(Rand)]++;
+  double TotalWeight = N * (N + 1) / 2;
+  for (size_t i = 0; i < N; i++) {
+    double Expected = N * TriesPerUnit * (i + 1) / TotalWeight;
+    EXPECT_GT(Hist[i], Expected * 0.9);
+    EXPECT_LT(Hist[i], Expected * 1.1);
+  }
+}
+
 TEST(Merge, Bad) {
   const char *kInvalidInputs[] = {
     "",
@@ -758,4 +778,28 @@ TEST(Fuzzer, ForEachNonZeroByte) {
   Expected = {          {109, 2}, {118, 3}, {120, 4},
               {135, 5}, {137, 6}, {146, 7}};
   EXPECT_EQ(Res, Expected);
+
+  // All-zero 64-byte blocks before, between and after the nonzero counters.
+  const size_t M = 320;
+  alignas(64) uint8_t Blocks[M] = {};
+  Blocks[70] = 1;
+  Blocks[127] = 2;
+  Blocks[256] = 3;
+  Blocks[261] = 4;
+  Blocks[262] = 5;
+  Res.clear();
+  ForEachNonZeroByte(Blocks, Blocks + M, 0, CB);
+  Expected = {{70, 1}, {127, 2}, {256, 3}, {261, 4}, {262, 5}};
+  EXPECT_EQ(Res, Expected);
+
+  // Unaligned begin, and an end in the middle of a block.
+  Res.clear();
+  ForEachNonZeroByte(Blocks + 3, Blocks + 262, 3, CB);
+  Expected = {{70, 1}, {127, 2}, {256, 3}, {261, 4}};
+  EXPECT_EQ(Res, Expected);
+
+  // Only zero blocks.
+  Res.clear();
+  ForEachNonZeroByte(Blocks + 128, Blocks + 256, 128, CB);
+  EXPECT_TRUE(Res.empty());
 }
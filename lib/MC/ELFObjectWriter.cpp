@@ -38,6 +38,7 @@
 #include "llvm/MC/StringTableBuilder.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -63,6 +64,11 @@ using namespace llvm;
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
+static cl::opt<bool> TailMergeStringTable(
+    "elf-tail-merge-strtab", cl::Hidden, cl::init(true),
+    cl::desc("Share the tails of the strings in the ELF string table. When "
+             "disabled the strings are only deduplicated, which is faster"));
+
 namespace {
 
 using SectionIndexMapTy = DenseMap<const MCSectionELF *, uint32_t>;
@@ -249,6 +255,11 @@ public:
                                               const MCFragment &FB, bool InSet,
                                               bool IsPCRel) const override;
 
+  /// Return roughly the number of bytes writeObject() will emit after the
+  /// ELF header.
+  uint64_t estimateObjectSize(const MCAssembler &Asm,
+                              const MCAsmLayout &Layout) const;
+
   void writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) override;
   void writeSection(const SectionIndexMapTy &SectionIndexMap,
                     uint32_t GroupSymbolIndex, uint64_t Offset, uint64_t Size,
@@ -900,7 +911,10 @@ void ELFObjectWriter::computeSymbolTable(
   for (const std::string &Name : FileNames)
     StrTabBuilder.add(Name);
 
-  StrTabBuilder.finalize();
+  if (TailMergeStringTable)
+    StrTabBuilder.finalize();
+  else
+    StrTabBuilder.finalizeInOrder();
 
   // File symbols are emitted first and handled separately from normal symbols,
   // i.e. a non-STT_FILE symbol with the same name may appear.
@@ -1223,6 +1237,28 @@ void ELFObjectWriter::writeSectionHeader(
   }
 }
 
+uint64_t ELFObjectWriter::estimateObjectSize(const MCAssembler &Asm,
+                                            const MCAsmLayout &Layout) const {
+  uint64_t Size = 0;
+  for (const MCSection &Sec : Asm)
+    Size += Sec.getAlignment() + Layout.getSectionFileSize(&Sec);
+
+  unsigned RelEntrySize;
+  if (is64Bit())
+    RelEntrySize = hasRelocationAddend() ? sizeof(ELF::Elf64_Rela)
+                                         : sizeof(ELF::Elf64_Rel);
+  else
+    RelEntrySize = hasRelocationAddend() ? sizeof(ELF::Elf32_Rela)
+                                         : sizeof(ELF::Elf32_Rel);
+  for (const auto &P : Relocations)
+    Size += P.second.size() * RelEntrySize;
+
+  unsigned SymEntrySize =
+      is64Bit() ? sizeof(ELF::Elf64_Sym) : sizeof(ELF::Elf32_Sym);
+  Size += (Asm.symbol_end() - Asm.symbol_begin()) * SymEntrySize;
+  return Size;
+}
+
 void ELFObjectWriter::writeObject(MCAssembler &Asm,
                                   const MCAsmLayout &Layout) {
   MCContext &Ctx = Asm.getContext();
@@ -1238,6 +1274,10 @@ void ELFObjectWriter::writeObject(MCAssembler &Asm,
   // Write out the ELF header ...
   writeHeader(Asm);
 
+  // Everything but the section headers is written sequentially, so tell the
+  // stream how much is coming to let it size its storage once.
+  getStream().reserveExtraSpace(estimateObjectSize(Asm, Layout));
+
   // ... then the sections ...
   SectionOffsetsTy SectionOffsets;
   std::vector<MCSectionELF *> Groups;
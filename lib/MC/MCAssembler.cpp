@@ -67,6 +67,12 @@ STATISTIC(evaluateFixup, "Number of evaluated fixups");
 STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
+STATISTIC(SectionRelaxationSteps,
+          "Number of assembler layout and relaxation steps on a section");
+STATISTIC(SkippedStableSections,
+          "Number of stable sections skipped by layout and relaxation steps");
+STATISTIC(RelaxationCandidates,
+          "Number of fragments checked for relaxation");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
 
 } // end namespace stats
@@ -102,6 +108,8 @@ void MCAssembler::reset() {
   SubsectionsViaSymbols = false;
   IncrementalLinkerCompatible = false;
   ELFHeaderEFlags = 0;
+  RelaxableFragments.clear();
+  SectionsToRelax.clear();
   LOHContainer.reset();
   VersionMinInfo.Major = 0;
 
@@ -689,6 +697,30 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
       Frag.setLayoutOrder(FragmentIndex++);
   }
 
+  // Collect the fragments that may need relaxing. Sections without any never
+  // change size after the first layout, so they are never visited.
+  RelaxableFragments.assign(SectionIndex, std::vector<MCFragment *>());
+  SectionsToRelax.reset();
+  SectionsToRelax.resize(SectionIndex);
+  for (MCSection &Sec : *this) {
+    for (MCFragment &Frag : Sec) {
+      switch (Frag.getKind()) {
+      default:
+        break;
+      case MCFragment::FT_Relaxable:
+      case MCFragment::FT_Dwarf:
+      case MCFragment::FT_DwarfFrame:
+      case MCFragment::FT_LEB:
+      case MCFragment::FT_CVInlineLines:
+      case MCFragment::FT_CVDefRange:
+        RelaxableFragments[Sec.getOrdinal()].push_back(&Frag);
+        break;
+      }
+    }
+    if (!RelaxableFragments[Sec.getOrdinal()].empty())
+      SectionsToRelax.set(Sec.getOrdinal());
+  }
+
   // Layout until everything fits.
   while (layoutOnce(Layout))
     if (getContext().hadError())
@@ -892,8 +924,11 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
 
+  ++stats::SectionRelaxationSteps;
+
   // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
+  for (MCFragment *I : RelaxableFragments[Sec.getOrdinal()]) {
+    ++stats::RelaxationCandidates;
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
     switch(I->getKind()) {
@@ -925,7 +960,7 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
       break;
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+      FirstRelaxedFragment = I;
   }
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
@@ -937,11 +972,32 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
 bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   ++stats::RelaxationSteps;
 
+  // The size of a fragment can depend on the layout of another section, e.g.
+  // a line table entry encodes the distance between two labels of .text. So
+  // once a section changes size, every other section has to be visited again,
+  // but a section that was found stable and saw no change since is skipped:
+  // visiting it again would not relax anything.
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSection &Sec = *it;
+    unsigned Ordinal = Sec.getOrdinal();
+    if (!SectionsToRelax.test(Ordinal)) {
+      if (!RelaxableFragments[Ordinal].empty())
+        ++stats::SkippedStableSections;
+      continue;
+    }
+    SectionsToRelax.reset(Ordinal);
+
+    bool SectionRelaxed = false;
     while (layoutSectionOnce(Layout, Sec))
-      WasRelaxed = true;
+      SectionRelaxed = true;
+    if (!SectionRelaxed)
+      continue;
+
+    WasRelaxed = true;
+    for (unsigned I = 0, E = RelaxableFragments.size(); I != E; ++I)
+      if (I != Ordinal && !RelaxableFragments[I].empty())
+        SectionsToRelax.set(I);
   }
 
   return WasRelaxed;
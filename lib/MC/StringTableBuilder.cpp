@@ -14,11 +14,14 @@
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -113,6 +116,41 @@ tailcall:
   }
 }
 
+// Tables with fewer strings than this are sorted on the calling thread; the
+// cost of dispatching tasks would dominate.
+static const size_t ParallelSortThreshold = 1 << 16;
+
+// Sort the strings in the same order as multikey_qsort(Begin, End, 0).
+//
+// The first partitioning step of multikey_qsort splits the strings by their
+// last character. Do that split up front with a counting sort and then sort
+// the 256 buckets independently, in parallel. All strings in the table are
+// distinct, so the sort order is total and the result is identical to the
+// serial sort.
+static void parallelMultikeySort(StringPair **Begin, StringPair **End) {
+  // Bucket 0 holds the empty string, which sorts last. Bucket I + 1 holds the
+  // strings ending with character I, and larger characters sort first.
+  size_t Counts[257] = {};
+  for (StringPair **I = Begin; I != End; ++I)
+    ++Counts[charTailAt(*I, 0) + 1];
+
+  size_t Offsets[257];
+  Offsets[256] = 0;
+  for (int C = 256; C > 0; --C)
+    Offsets[C - 1] = Offsets[C] + Counts[C];
+
+  std::vector<StringPair *> Sorted(End - Begin);
+  size_t Next[257];
+  std::copy(std::begin(Offsets), std::end(Offsets), std::begin(Next));
+  for (StringPair **I = Begin; I != End; ++I)
+    Sorted[Next[charTailAt(*I, 0) + 1]++] = *I;
+  std::copy(Sorted.begin(), Sorted.end(), Begin);
+
+  parallel::for_each_n(parallel::par, 1, 257, [&](int C) {
+    multikey_qsort(Begin + Offsets[C], Begin + Offsets[C] + Counts[C], 1);
+  });
+}
+
 void StringTableBuilder::finalize() {
   finalizeStringTable(/*Optimize=*/true);
 }
@@ -133,7 +171,10 @@ void StringTableBuilder::finalizeStringTable(bool Optimize) {
     if (!Strings.empty()) {
       // If we're optimizing, sort by name. If not, sort by previously assigned
       // offset.
-      multikey_qsort(&Strings[0], &Strings[0] + Strings.size(), 0);
+      if (Strings.size() >= ParallelSortThreshold)
+        parallelMultikeySort(&Strings[0], &Strings[0] + Strings.size());
+      else
+        multikey_qsort(&Strings[0], &Strings[0] + Strings.size(), 0);
     }
 
     initSize();
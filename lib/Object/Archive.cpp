@@ -971,20 +971,44 @@ uint32_t Archive::getNumberOfSymbols() const {
   return read32le(buf);
 }
 
+void Archive::buildSymbolMap() const {
+  // The lookups are const, so several threads may get here at once. A flag
+  // separate from the map also keeps an empty symbol table from being scanned
+  // on every lookup.
+  llvm::call_once(SymbolMapBuilt, [this] {
+    for (const Symbol &Sym : symbols())
+      SymbolMap.insert(std::make_pair(Sym.getName(), Sym));
+  });
+}
+
 Expected<Optional<Archive::Child>> Archive::findSym(StringRef name) const {
-  Archive::symbol_iterator bs = symbol_begin();
-  Archive::symbol_iterator es = symbol_end();
-
-  for (; bs != es; ++bs) {
-    StringRef SymName = bs->getName();
-    if (SymName == name) {
-      if (auto MemberOrErr = bs->getMember())
-        return Child(*MemberOrErr);
-      else
-        return MemberOrErr.takeError();
+  buildSymbolMap();
+  auto It = SymbolMap.find(name);
+  if (It == SymbolMap.end())
+    return Optional<Child>();
+  if (auto MemberOrErr = It->second.getMember())
+    return Child(*MemberOrErr);
+  else
+    return MemberOrErr.takeError();
+}
+
+Expected<std::vector<Optional<Archive::Child>>>
+Archive::findSyms(ArrayRef<StringRef> Names) const {
+  buildSymbolMap();
+  std::vector<Optional<Child>> Members;
+  Members.reserve(Names.size());
+  for (StringRef Name : Names) {
+    auto It = SymbolMap.find(Name);
+    if (It == SymbolMap.end()) {
+      Members.push_back(None);
+      continue;
     }
+    auto MemberOrErr = It->second.getMember();
+    if (!MemberOrErr)
+      return MemberOrErr.takeError();
+    Members.push_back(std::move(*MemberOrErr));
   }
-  return Optional<Child>();
+  return std::move(Members);
 }
 
 // Returns true if archive file contains no member file.
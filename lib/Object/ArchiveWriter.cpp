@@ -24,6 +24,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -280,27 +282,86 @@ static sys::TimePoint<std::chrono::seconds> now(bool Deterministic) {
   return sys::TimePoint<seconds>();
 }
 
+namespace {
+// The symbols of an archive member that go in the symbol table.
+struct MemberSymbols {
+  // False if the member isn't an object file.
+  bool IsSymbolic = false;
+  // The names of the symbols, each terminated by a null character.
+  std::string Names;
+  std::error_code EC;
+};
+} // end anonymous namespace
+
+static MemberSymbols getMemberSymbols(MemoryBufferRef MemberBuffer) {
+  MemberSymbols Result;
+  // Bitcode members need a context of their own, as members are read
+  // concurrently.
+  std::unique_ptr<LLVMContext> Context;
+  if (identify_magic(MemberBuffer.getBuffer()) == file_magic::bitcode)
+    Context = llvm::make_unique<LLVMContext>();
+  Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
+      object::SymbolicFile::createSymbolicFile(
+          MemberBuffer, llvm::file_magic::unknown, Context.get());
+  if (!ObjOrErr) {
+    // FIXME: check only for "not an object file" errors.
+    consumeError(ObjOrErr.takeError());
+    return Result;
+  }
+  object::SymbolicFile &Obj = *ObjOrErr.get();
+  Result.IsSymbolic = true;
+
+  raw_string_ostream NameOS(Result.Names);
+  for (const object::BasicSymbolRef &S : Obj.symbols()) {
+    uint32_t Symflags = S.getFlags();
+    if (Symflags & object::SymbolRef::SF_FormatSpecific)
+      continue;
+    if (!(Symflags & object::SymbolRef::SF_Global))
+      continue;
+    if (Symflags & object::SymbolRef::SF_Undefined &&
+        !(Symflags & object::SymbolRef::SF_Indirect))
+      continue;
+
+    if (auto EC = S.printName(NameOS)) {
+      Result.EC = EC;
+      break;
+    }
+    NameOS << '\0';
+  }
+  NameOS.flush();
+  return Result;
+}
+
 // Returns the offset of the first reference to a member offset.
 static ErrorOr<unsigned>
 writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
                  ArrayRef<NewArchiveMember> Members,
                  std::vector<unsigned> &MemberOffsetRefs, bool Deterministic) {
+  // Reading the symbols of the members dominates the time it takes to write
+  // large archives, and members are independent, so read them concurrently.
+  std::vector<MemberSymbols> Symbols(Members.size());
+  if (Members.size() > 1) {
+    ThreadPool Pool(std::min<unsigned>(heavyweight_hardware_concurrency(),
+                                       Members.size()));
+    for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N;
+         ++MemberNum)
+      Pool.async([&Symbols, &Members, MemberNum] {
+        Symbols[MemberNum] =
+            getMemberSymbols(Members[MemberNum].Buf->getMemBufferRef());
+      });
+    Pool.wait();
+  } else if (Members.size() == 1) {
+    Symbols[0] = getMemberSymbols(Members[0].Buf->getMemBufferRef());
+  }
+
   unsigned HeaderStartOffset = 0;
   unsigned BodyStartOffset = 0;
   SmallString<128> NameBuf;
   raw_svector_ostream NameOS(NameBuf);
-  LLVMContext Context;
   for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N; ++MemberNum) {
-    MemoryBufferRef MemberBuffer = Members[MemberNum].Buf->getMemBufferRef();
-    Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
-        object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, llvm::file_magic::unknown, &Context);
-    if (!ObjOrErr) {
-      // FIXME: check only for "not an object file" errors.
-      consumeError(ObjOrErr.takeError());
+    const MemberSymbols &MemberSyms = Symbols[MemberNum];
+    if (!MemberSyms.IsSymbolic)
       continue;
-    }
-    object::SymbolicFile &Obj = *ObjOrErr.get();
 
     if (!HeaderStartOffset) {
       HeaderStartOffset = Out.tell();
@@ -312,25 +373,19 @@ writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
       print32(Out, Kind, 0); // number of entries or bytes
     }
 
-    for (const object::BasicSymbolRef &S : Obj.symbols()) {
-      uint32_t Symflags = S.getFlags();
-      if (Symflags & object::SymbolRef::SF_FormatSpecific)
-        continue;
-      if (!(Symflags & object::SymbolRef::SF_Global))
-        continue;
-      if (Symflags & object::SymbolRef::SF_Undefined &&
-          !(Symflags & object::SymbolRef::SF_Indirect))
-        continue;
-
+    StringRef Names = MemberSyms.Names;
+    while (!Names.empty()) {
+      StringRef Name;
+      std::tie(Name, Names) = Names.split('\0');
       unsigned NameOffset = NameOS.tell();
-      if (auto EC = S.printName(NameOS))
-        return EC;
-      NameOS << '\0';
+      NameOS << Name << '\0';
       MemberOffsetRefs.push_back(MemberNum);
       if (isBSDLike(Kind))
         print32(Out, Kind, NameOffset);
       print32(Out, Kind, 0); // member offset
     }
+    if (MemberSyms.EC)
+      return MemberSyms.EC;
   }
 
   if (HeaderStartOffset == 0)
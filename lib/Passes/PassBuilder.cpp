@@ -172,6 +172,38 @@ static cl::opt<bool> EnableGVNSink(
     "enable-npm-gvn-sink", cl::init(false), cl::Hidden,
     cl::desc("Enable the GVN hoisting pass for the new PM (default = off)"));
 
+static cl::opt<bool> EnableColdFunctionTiering(
+    "enable-npm-cold-function-tiering", cl::init(false), cl::Hidden,
+    cl::desc("Run a cheap, fixed function pipeline on functions whose entry "
+             "is cold according to the profile (default = off)"));
+
+namespace {
+/// Runs one of two function pipelines depending on whether the entry of the
+/// function is cold according to the profile summary of its module.
+///
+/// The \c ProfileSummaryAnalysis has to be cached for the module already;
+/// without it every function is treated as hot.
+class ProfileTieredFunctionPass
+    : public PassInfoMixin<ProfileTieredFunctionPass> {
+  FunctionPassManager HotPM;
+  FunctionPassManager ColdPM;
+
+public:
+  ProfileTieredFunctionPass(FunctionPassManager HotPM,
+                            FunctionPassManager ColdPM)
+      : HotPM(std::move(HotPM)), ColdPM(std::move(ColdPM)) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) {
+    auto &MAM = AM.getResult<ModuleAnalysisManagerFunctionProxy>(F).getManager();
+    ProfileSummaryInfo *PSI =
+        MAM.getCachedResult<ProfileSummaryAnalysis>(*F.getParent());
+    if (PSI && PSI->isFunctionEntryCold(&F))
+      return ColdPM.run(F, AM);
+    return HotPM.run(F, AM);
+  }
+};
+} // end anonymous namespace
+
 static Regex DefaultAliasRegex(
     "^(default|thinlto-pre-link|thinlto|lto-pre-link|lto)<(O[0123sz])>$");
 
@@ -454,6 +486,23 @@ PassBuilder::buildFunctionSimplificationPipeline(OptimizationLevel Level,
   return FPM;
 }
 
+FunctionPassManager
+PassBuilder::buildColdFunctionSimplificationPipeline(OptimizationLevel Level,
+                                                     bool DebugLogging) {
+  assert(Level != O0 && "Must request optimizations!");
+  FunctionPassManager FPM(DebugLogging);
+
+  // Only do the basic cleanups: break apart aggregates, catch trivial
+  // redundancies and canonicalize. Everything here is roughly linear.
+  FPM.addPass(SROA());
+  FPM.addPass(EarlyCSEPass());
+  FPM.addPass(SimplifyCFGPass());
+  FPM.addPass(InstCombinePass());
+  invokePeepholeEPCallbacks(FPM, Level);
+
+  return FPM;
+}
+
 void PassBuilder::addPGOInstrPasses(ModulePassManager &MPM, bool DebugLogging,
                                     PassBuilder::OptimizationLevel Level,
                                     bool RunProfileGen,
@@ -628,10 +677,17 @@ PassBuilder::buildModuleSimplificationPipeline(OptimizationLevel Level,
     MainCGPipeline.addPass(ArgumentPromotionPass());
 
   // Lastly, add the core function simplification pipeline nested inside the
-  // CGSCC walk.
-  MainCGPipeline.addPass(createCGSCCToFunctionPassAdaptor(
-      buildFunctionSimplificationPipeline(Level, DebugLogging,
-                                          PrepareForThinLTO)));
+  // CGSCC walk. When tiering is enabled, functions with a cold entry only get
+  // a cheap cleanup.
+  FunctionPassManager FPM = buildFunctionSimplificationPipeline(
+      Level, DebugLogging, PrepareForThinLTO);
+  if (EnableColdFunctionTiering)
+    MainCGPipeline.addPass(
+        createCGSCCToFunctionPassAdaptor(ProfileTieredFunctionPass(
+            std::move(FPM),
+            buildColdFunctionSimplificationPipeline(Level, DebugLogging))));
+  else
+    MainCGPipeline.addPass(createCGSCCToFunctionPassAdaptor(std::move(FPM)));
 
   for (auto &C : CGSCCOptimizerLateEPCallbacks)
     C(MainCGPipeline, Level);
@@ -756,8 +812,19 @@ PassBuilder::buildModuleOptimizationPipeline(OptimizationLevel Level,
   // resulted in single-entry-single-exit or empty blocks. Clean up the CFG.
   OptimizePM.addPass(SimplifyCFGPass());
 
-  // Add the core optimizing pipeline.
-  MPM.addPass(createModuleToFunctionPassAdaptor(std::move(OptimizePM)));
+  // Add the core optimizing pipeline. When tiering is enabled, functions with
+  // a cold entry are neither vectorized nor unrolled, and only get the final
+  // cleanup.
+  if (EnableColdFunctionTiering) {
+    FunctionPassManager ColdOptimizePM(DebugLogging);
+    ColdOptimizePM.addPass(InstSimplifierPass());
+    ColdOptimizePM.addPass(SimplifyCFGPass());
+    MPM.addPass(RequireAnalysisPass<ProfileSummaryAnalysis, Module>());
+    MPM.addPass(createModuleToFunctionPassAdaptor(ProfileTieredFunctionPass(
+        std::move(OptimizePM), std::move(ColdOptimizePM))));
+  } else {
+    MPM.addPass(createModuleToFunctionPassAdaptor(std::move(OptimizePM)));
+  }
 
   // Now we need to do some global optimization transforms.
   // FIXME: It would seem like these should come first in the optimization
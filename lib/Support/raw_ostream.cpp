@@ -645,6 +645,17 @@ void raw_fd_ostream::pwrite_impl(const char *Ptr, size_t Size,
   seek(Pos);
 }
 
+void raw_fd_ostream::reserveExtraSpace(uint64_t ExtraSize) {
+  // Don't buffer more than this much; past that point the number of write
+  // calls no longer matters.
+  const uint64_t MaxBufferSize = 1 << 20;
+  size_t BufferSize = GetBufferSize();
+  if (BufferSize == 0 || BufferSize >= MaxBufferSize ||
+      ExtraSize <= BufferSize)
+    return;
+  SetBufferSize(std::min(ExtraSize, MaxBufferSize));
+}
+
 size_t raw_fd_ostream::preferred_buffer_size() const {
 #if !defined(_MSC_VER) && !defined(__MINGW32__) && !defined(__minix)
   // Windows and Minix have no st_blksize.
@@ -2012,6 +2012,7 @@ static bool isProfitableToMakeFastCC(Function *F) {
 static bool
 OptimizeFunctions(Module &M, TargetLibraryInfo *TLI,
                   function_ref<DominatorTree &(Function &)> LookupDomTree,
+                  function_ref<void(Function &)> ChangedCFGCallback,
                   SmallSet<const Comdat *, 8> &NotDiscardableComdats) {
   bool Changed = false;
   // Optimize functions.
@@ -2034,12 +2035,12 @@ OptimizeFunctions(Module &M, TargetLibraryInfo *TLI,
     // So, remove unreachable blocks from the function, because a) there's
     // no point in analyzing them and b) GlobalOpt should otherwise grow
     // some more complicated logic to break these cycles.
-    // Removing unreachable blocks might invalidate the dominator so we
-    // recalculate it.
+    // Removing unreachable blocks invalidates the analyses of the function
+    // that depend on its CFG, so let the caller drop them. The dominator tree
+    // is only recomputed if processing the globals below actually needs it.
     if (!F->isDeclaration()) {
       if (removeUnreachableBlocks(*F)) {
-        auto &DT = LookupDomTree(*F);
-        DT.recalculate(*F);
+        ChangedCFGCallback(*F);
         Changed = true;
       }
     }
@@ -2514,7 +2515,8 @@ static bool OptimizeEmptyGlobalCXXDtors(Function *CXAAtExitFn) {
 
 static bool optimizeGlobalsInModule(
     Module &M, const DataLayout &DL, TargetLibraryInfo *TLI,
-    function_ref<DominatorTree &(Function &)> LookupDomTree) {
+    function_ref<DominatorTree &(Function &)> LookupDomTree,
+    function_ref<void(Function &)> ChangedCFGCallback) {
   SmallSet<const Comdat *, 8> NotDiscardableComdats;
   bool Changed = false;
   bool LocalChange = true;
@@ -2536,8 +2538,8 @@ static bool optimizeGlobalsInModule(
           NotDiscardableComdats.insert(C);
 
     // Delete functions that are trivially dead, ccc -> fastcc
-    LocalChange |=
-        OptimizeFunctions(M, TLI, LookupDomTree, NotDiscardableComdats);
+    LocalChange |= OptimizeFunctions(M, TLI, LookupDomTree, ChangedCFGCallback,
+                                     NotDiscardableComdats);
 
     // Optimize global_ctors list.
     LocalChange |= optimizeGlobalCtorsList(M, [&](Function *F) {
@@ -2574,7 +2576,11 @@ PreservedAnalyses GlobalOptPass::run(Module &M, ModuleAnalysisManager &AM) {
     auto LookupDomTree = [&FAM](Function &F) -> DominatorTree &{
       return FAM.getResult<DominatorTreeAnalysis>(F);
     };
-    if (!optimizeGlobalsInModule(M, DL, &TLI, LookupDomTree))
+    auto ChangedCFGCallback = [&FAM](Function &F) {
+      FAM.invalidate(F, PreservedAnalyses::none());
+    };
+    if (!optimizeGlobalsInModule(M, DL, &TLI, LookupDomTree,
+                                 ChangedCFGCallback))
       return PreservedAnalyses::all();
     return PreservedAnalyses::none();
 }
@@ -2595,7 +2601,11 @@ struct GlobalOptLegacyPass : public ModulePass {
     auto LookupDomTree = [this](Function &F) -> DominatorTree & {
       return this->getAnalysis<DominatorTreeWrapperPass>(F).getDomTree();
     };
-    return optimizeGlobalsInModule(M, DL, TLI, LookupDomTree);
+    // Function analyses requested by a module pass are recomputed on every
+    // query, so there is nothing to invalidate.
+    auto ChangedCFGCallback = [](Function &) {};
+    return optimizeGlobalsInModule(M, DL, TLI, LookupDomTree,
+                                   ChangedCFGCallback);
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
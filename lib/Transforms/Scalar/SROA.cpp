@@ -51,6 +51,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Local.h"
@@ -76,6 +77,8 @@ STATISTIC(NumPromoted, "Number of allocas promoted to SSA values");
 STATISTIC(NumLoadsSpeculated, "Number of loads speculated to allow promotion");
 STATISTIC(NumDeleted, "Number of instructions deleted");
 STATISTIC(NumVectorized, "Number of vectorized aggregates");
+STATISTIC(NumAllocasOverBudget,
+          "Number of allocas not split because they have too many slices");
 
 /// Hidden option to enable randomly shuffling the slices to help uncover
 /// instability in their order.
@@ -87,6 +90,13 @@ static cl::opt<bool> SROARandomShuffleSlices("sroa-random-shuffle-slices",
 static cl::opt<bool> SROAStrictInbounds("sroa-strict-inbounds", cl::init(false),
                                         cl::Hidden);
 
+/// Hidden option to bound the compile time spent on a single alloca. Building,
+/// sorting and partitioning the slices of an alloca is superlinear in their
+/// number, so allocas with more slices than this are not split.
+static cl::opt<unsigned> SROAMaxAllocaSlices(
+    "sroa-max-alloca-slices", cl::init(16384), cl::Hidden,
+    cl::desc("Maximum number of slices of an alloca that SROA will split"));
+
 namespace {
 /// \brief A custom IRBuilder inserter which prefixes all names, but only in
 /// Assert builds.
@@ -205,6 +215,12 @@ public:
   /// ignored.
   bool isEscaped() const { return PointerEscapingInstr; }
 
+  /// \brief Test whether building the slices was abandoned because the alloca
+  /// has more slices than the budget allows.
+  ///
+  /// Such an alloca is also reported as escaped.
+  bool isOverBudget() const { return OverBudget; }
+
   /// \brief Support for iterating over the slices.
   /// @{
   typedef SmallVectorImpl<Slice>::iterator iterator;
@@ -279,6 +295,9 @@ private:
   /// alloca. This will be null if the alloca slices are analyzed successfully.
   Instruction *PointerEscapingInstr;
 
+  /// \brief Whether the slice budget was exceeded while building the slices.
+  bool OverBudget;
+
   /// \brief The slices of the alloca.
   ///
   /// We store a vector of the slices formed by uses of the alloca here. This
@@ -662,6 +681,16 @@ private:
     }
 
     AS.Slices.push_back(Slice(BeginOffset, EndOffset, U, IsSplittable));
+
+    // Give up on allocas with so many uses that splitting them would take an
+    // unreasonable amount of compile time.
+    if (AS.Slices.size() > SROAMaxAllocaSlices) {
+      DEBUG(dbgs() << "WARNING: Giving up after " << AS.Slices.size()
+                   << " slices of alloca: " << AS.AI << "\n");
+      AS.OverBudget = true;
+      ++NumAllocasOverBudget;
+      PI.setAborted(&I);
+    }
   }
 
   void visitBitCastInst(BitCastInst &BC) {
@@ -984,7 +1013,7 @@ AllocaSlices::AllocaSlices(const DataLayout &DL, AllocaInst &AI)
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
       AI(AI),
 #endif
-      PointerEscapingInstr(nullptr) {
+      PointerEscapingInstr(nullptr), OverBudget(false) {
   SliceBuilder PB(DL, AI, *this);
   SliceBuilder::PtrInfo PtrI = PB.visitPtr(AI);
   if (PtrI.isEscaped() || PtrI.isAborted()) {
@@ -1008,8 +1037,11 @@ AllocaSlices::AllocaSlices(const DataLayout &DL, AllocaInst &AI)
 #endif
 
   // Sort the uses. This arranges for the offsets to be in ascending order,
-  // and the sizes to be in descending order.
-  std::sort(Slices.begin(), Slices.end());
+  // and the sizes to be in descending order. Generated code frequently
+  // accesses large allocas in increasing offset order, in which case the
+  // linear check saves the sort.
+  if (!std::is_sorted(Slices.begin(), Slices.end()))
+    std::sort(Slices.begin(), Slices.end());
 }
 
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
@@ -4103,6 +4135,8 @@ void SROA::clobberUse(Use &U) {
 /// the slices of the alloca, and then hands it off to be split and
 /// rewritten as needed.
 bool SROA::runOnAlloca(AllocaInst &AI) {
+  NamedRegionTimer T("alloca", "SROA Alloca Rewriting", "sroa",
+                     "Scalar Replacement Of Aggregates", TimePassesIsEnabled);
   DEBUG(dbgs() << "SROA alloca: " << AI << "\n");
   ++NumAllocasAnalyzed;
 
@@ -4128,8 +4162,13 @@ bool SROA::runOnAlloca(AllocaInst &AI) {
   // Build the slices using a recursive instruction-visiting builder.
   AllocaSlices AS(DL, AI);
   DEBUG(AS.print(dbgs()));
-  if (AS.isEscaped())
+  if (AS.isEscaped()) {
+    // An alloca with too many slices to split may still be promotable as a
+    // whole, which is linear in the number of its uses.
+    if (AS.isOverBudget() && isAllocaPromotable(&AI))
+      PromotableAllocas.push_back(&AI);
     return Changed;
+  }
 
   // Delete all the dead users of this alloca before splitting and rewriting it.
   for (Instruction *DeadUser : AS.getDeadUsers()) {
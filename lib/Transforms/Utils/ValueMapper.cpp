@@ -874,14 +874,11 @@ void Mapper::remapInstruction(Instruction *I) {
     return;
 
   // If the instruction's type is being remapped, do so now.
+  // Remap the function type as a whole rather than rebuilding it from its
+  // parameters, so that the type mapper can cache it for later call sites.
   if (auto CS = CallSite(I)) {
-    SmallVector<Type *, 3> Tys;
-    FunctionType *FTy = CS.getFunctionType();
-    Tys.reserve(FTy->getNumParams());
-    for (Type *Ty : FTy->params())
-      Tys.push_back(TypeMapper->remapType(Ty));
-    CS.mutateFunctionType(FunctionType::get(
-        TypeMapper->remapType(I->getType()), Tys, FTy->isVarArg()));
+    CS.mutateFunctionType(
+        cast<FunctionType>(TypeMapper->remapType(CS.getFunctionType())));
     return;
   }
   if (auto *AI = dyn_cast<AllocaInst>(I))
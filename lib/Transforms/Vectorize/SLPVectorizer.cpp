@@ -16,6 +16,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "llvm/Transforms/Vectorize/SLPVectorizer.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
@@ -37,10 +38,12 @@
 #include "llvm/IR/Value.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/KnownBits.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
 #include "llvm/Transforms/Vectorize.h"
@@ -54,6 +57,14 @@ using namespace slpvectorizer;
 #define DEBUG_TYPE "SLP"
 
 STATISTIC(NumVectorInstructions, "Number of vector instructions generated");
+STATISTIC(NumIllegalBundleCacheHits,
+          "Number of bundles gathered because they were known to be illegal");
+STATISTIC(NumUnprofitableTreesSkipped,
+          "Number of trees not built because their roots were known to be "
+          "unprofitable");
+
+static const char SLPTimerGroupName[] = "slp";
+static const char SLPTimerGroupDescription[] = "SLP Vectorizer";
 
 static cl::opt<int>
     SLPCostThreshold("slp-threshold", cl::init(0), cl::Hidden,
@@ -411,6 +422,15 @@ public:
   /// vectorizable. We do not vectorize such trees.
   bool isTreeTinyAndNotFullyVectorizable();
 
+  /// \returns True if a tree with the roots \p Roots (in this order) was
+  /// already built and found to be tiny or unprofitable, and the IR has not
+  /// been changed by the vectorizer since. Building it again can only give
+  /// the same or a worse result, because the scheduling region budget of a
+  /// block only shrinks.
+  bool isKnownUnprofitableTree(ArrayRef<Value *> Roots) const {
+    return UnprofitableRoots.count(Roots);
+  }
+
   OptimizationRemarkEmitter *getORE() { return ORE; }
 
 private:
@@ -425,6 +445,48 @@ private:
   /// This is the recursive part of buildTree.
   void buildTree_rec(ArrayRef<Value *> Roots, unsigned Depth, int);
 
+  /// \returns a copy of \p VL that lives as long as the bundle caches.
+  ArrayRef<Value *> copyBundle(ArrayRef<Value *> VL) {
+    Value **Mem = BundleCacheAllocator.Allocate<Value *>(VL.size());
+    std::uninitialized_copy(VL.begin(), VL.end(), Mem);
+    return makeArrayRef(Mem, VL.size());
+  }
+
+  /// \returns True if \p VL failed one of the order-independent legality
+  /// checks of buildTree_rec before.
+  bool isKnownIllegalBundle(ArrayRef<Value *> VL) const {
+    SmallVector<Value *, 8> Sorted(VL.begin(), VL.end());
+    std::sort(Sorted.begin(), Sorted.end());
+    return IllegalBundles.count(Sorted);
+  }
+
+  /// Remember that the scalars in \p VL can never be vectorized together, no
+  /// matter in which order or from which seed they are reached.
+  void rememberIllegalBundle(ArrayRef<Value *> VL) {
+    SmallVector<Value *, 8> Sorted(VL.begin(), VL.end());
+    std::sort(Sorted.begin(), Sorted.end());
+    if (!IllegalBundles.count(Sorted))
+      IllegalBundles.insert(copyBundle(Sorted));
+  }
+
+  /// Remember that the current tree is not worth vectorizing, if its result
+  /// only depends on its roots.
+  void rememberUnprofitableTree() {
+    if (!IsMemoizableTree || VectorizableTree.empty())
+      return;
+    ArrayRef<Value *> Roots = VectorizableTree[0].Scalars;
+    if (!UnprofitableRoots.count(Roots))
+      UnprofitableRoots.insert(copyBundle(Roots));
+  }
+
+  /// Forget all memoized legality and cost results. This must be called
+  /// whenever the vectorizer changes the IR.
+  void clearBundleCaches() {
+    IllegalBundles.clear();
+    UnprofitableRoots.clear();
+    BundleCacheAllocator.Reset();
+  }
+
   /// \returns True if the ExtractElement/ExtractValue instructions in VL can
   /// be vectorized to use the original vector (or aggregate "bitcast" to a vector).
   bool canReuseExtract(ArrayRef<Value *> VL, Value *OpValue) const;
@@ -546,6 +608,22 @@ private:
   /// Maps a specific scalar to its tree entry.
   SmallDenseMap<Value*, int> ScalarToTreeEntry;
 
+  /// Bundles that can never be vectorized, keyed on the sorted scalar list.
+  /// Only checks that depend neither on the order of the scalars nor on the
+  /// tree being built are recorded, so the same operand bundle reached from
+  /// a different seed is gathered without being scheduled again.
+  DenseSet<ArrayRef<Value *>> IllegalBundles;
+
+  /// Roots of trees that were found to be tiny or unprofitable.
+  DenseSet<ArrayRef<Value *>> UnprofitableRoots;
+
+  /// Storage for the keys of IllegalBundles and UnprofitableRoots.
+  BumpPtrAllocator BundleCacheAllocator;
+
+  /// True if the current tree was built without ignored or externally used
+  /// values, i.e. its cost only depends on its roots.
+  bool IsMemoizableTree = false;
+
   /// A list of scalars that we found that we need to keep as scalars.
   ValueSet MustGather;
 
@@ -1060,8 +1138,11 @@ void BoUpSLP::buildTree(ArrayRef<Value *> Roots,
 void BoUpSLP::buildTree(ArrayRef<Value *> Roots,
                         ExtraValueToDebugLocsMap &ExternallyUsedValues,
                         ArrayRef<Value *> UserIgnoreLst) {
+  NamedRegionTimer T("build_tree", "SLP Tree Building", SLPTimerGroupName,
+                     SLPTimerGroupDescription, TimePassesIsEnabled);
   deleteTree();
   UserIgnoreList = UserIgnoreLst;
+  IsMemoizableTree = UserIgnoreLst.empty() && ExternallyUsedValues.empty();
   if (!allSameType(Roots))
     return;
   buildTree_rec(Roots, 0, -1);
@@ -1131,6 +1212,13 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
     return;
   }
 
+  if (isKnownIllegalBundle(VL)) {
+    DEBUG(dbgs() << "SLP: Gathering due to a known illegal bundle.\n");
+    ++NumIllegalBundleCacheHits;
+    newTreeEntry(VL, false, UserTreeIdx);
+    return;
+  }
+
   // Don't handle vectors.
   if (VL[0]->getType()->isVectorTy()) {
     DEBUG(dbgs() << "SLP: Gathering due to vector type.\n");
@@ -1262,6 +1350,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
           if (Term) {
             DEBUG(dbgs() << "SLP: Need to swizzle PHINodes (TerminatorInst use).\n");
             BS.cancelScheduling(VL, VL0);
+            rememberIllegalBundle(VL);
             newTreeEntry(VL, false, UserTreeIdx);
             return;
           }
@@ -1305,6 +1394,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
       if (DL->getTypeSizeInBits(ScalarTy) !=
           DL->getTypeAllocSizeInBits(ScalarTy)) {
         BS.cancelScheduling(VL, VL0);
+        rememberIllegalBundle(VL);
         newTreeEntry(VL, false, UserTreeIdx);
         DEBUG(dbgs() << "SLP: Gathering loads of non-packed type.\n");
         return;
@@ -1380,6 +1470,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
         Type *Ty = cast<Instruction>(VL[i])->getOperand(0)->getType();
         if (Ty != SrcTy || !isValidElementType(Ty)) {
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           DEBUG(dbgs() << "SLP: Gathering casts with different src types.\n");
           return;
@@ -1408,6 +1499,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
         if (Cmp->getPredicate() != P0 ||
             Cmp->getOperand(0)->getType() != ComparedTy) {
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           DEBUG(dbgs() << "SLP: Gathering cmp with different predicate.\n");
           return;
@@ -1475,6 +1567,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
         if (cast<Instruction>(VL[j])->getNumOperands() != 2) {
           DEBUG(dbgs() << "SLP: not-vectorizable GEP (nested indexes).\n");
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           return;
         }
@@ -1488,6 +1581,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
         if (Ty0 != CurTy) {
           DEBUG(dbgs() << "SLP: not-vectorizable GEP (different types).\n");
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           return;
         }
@@ -1500,6 +1594,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
           DEBUG(
               dbgs() << "SLP: not-vectorizable GEP (non-constant indexes).\n");
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           return;
         }
@@ -1545,6 +1640,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
       Intrinsic::ID ID = getVectorIntrinsicIDForCall(CI, TLI);
       if (!isTriviallyVectorizable(ID)) {
         BS.cancelScheduling(VL, VL0);
+        rememberIllegalBundle(VL);
         newTreeEntry(VL, false, UserTreeIdx);
         DEBUG(dbgs() << "SLP: Non-vectorizable call.\n");
         return;
@@ -1559,6 +1655,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
             getVectorIntrinsicIDForCall(CI2, TLI) != ID ||
             !CI->hasIdenticalOperandBundleSchema(*CI2)) {
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           DEBUG(dbgs() << "SLP: mismatched calls:" << *CI << "!=" << *VL[i]
                        << "\n");
@@ -1570,6 +1667,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
           Value *A1J = CI2->getArgOperand(1);
           if (A1I != A1J) {
             BS.cancelScheduling(VL, VL0);
+            rememberIllegalBundle(VL);
             newTreeEntry(VL, false, UserTreeIdx);
             DEBUG(dbgs() << "SLP: mismatched arguments in call:" << *CI
                          << " argument "<< A1I<<"!=" << A1J
@@ -1583,6 +1681,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
                         CI->op_begin() + CI->getBundleOperandsEndIndex(),
                         CI2->op_begin() + CI2->getBundleOperandsStartIndex())) {
           BS.cancelScheduling(VL, VL0);
+          rememberIllegalBundle(VL);
           newTreeEntry(VL, false, UserTreeIdx);
           DEBUG(dbgs() << "SLP: mismatched bundle operands in calls:" << *CI << "!="
                        << *VL[i] << '\n');
@@ -1635,6 +1734,7 @@ void BoUpSLP::buildTree_rec(ArrayRef<Value *> VL, unsigned Depth,
     }
     default:
       BS.cancelScheduling(VL, VL0);
+      rememberIllegalBundle(VL);
       newTreeEntry(VL, false, UserTreeIdx);
       DEBUG(dbgs() << "SLP: Gathering unknown instruction.\n");
       return;
@@ -1988,6 +2088,7 @@ bool BoUpSLP::isTreeTinyAndNotFullyVectorizable() {
 
   // Otherwise, we can't vectorize the tree. It is both tiny and not fully
   // vectorizable.
+  rememberUnprofitableTree();
   return true;
 }
 
@@ -2054,6 +2155,8 @@ int BoUpSLP::getSpillCost() {
 }
 
 int BoUpSLP::getTreeCost() {
+  NamedRegionTimer T("tree_cost", "SLP Tree Cost", SLPTimerGroupName,
+                     SLPTimerGroupDescription, TimePassesIsEnabled);
   int Cost = 0;
   DEBUG(dbgs() << "SLP: Calculating cost for tree of size " <<
         VectorizableTree.size() << ".\n");
@@ -2113,6 +2216,9 @@ int BoUpSLP::getTreeCost() {
   if (ViewSLPTree)
     ViewGraph(this, "SLP" + F->getName(), false, Str);
 
+  if (Cost >= -SLPCostThreshold)
+    rememberUnprofitableTree();
+
   return Cost;
 }
 
@@ -2862,6 +2968,12 @@ Value *BoUpSLP::vectorizeTree() {
 
 Value *
 BoUpSLP::vectorizeTree(ExtraValueToDebugLocsMap &ExternallyUsedValues) {
+  NamedRegionTimer T("vectorize_tree", "SLP Tree Vectorization",
+                     SLPTimerGroupName, SLPTimerGroupDescription,
+                     TimePassesIsEnabled);
+
+  // The memoized results refer to the IR we are about to change.
+  clearBundleCaches();
 
   // All blocks must be scheduled before any instructions are inserted.
   for (auto &BSIter : BlocksSchedules) {
@@ -3012,6 +3124,10 @@ BoUpSLP::vectorizeTree(ExtraValueToDebugLocsMap &ExternallyUsedValues) {
 }
 
 void BoUpSLP::optimizeGatherSequence() {
+  NamedRegionTimer T("optimize_gathers", "SLP Gather Optimization",
+                     SLPTimerGroupName, SLPTimerGroupDescription,
+                     TimePassesIsEnabled);
+  clearBundleCaches();
   DEBUG(dbgs() << "SLP: Optimizing " << GatherSeq.size()
         << " gather sequences instructions.\n");
   // LICM InsertElementInst sequences.
@@ -3943,6 +4059,11 @@ bool SLPVectorizerPass::vectorizeStoreChain(ArrayRef<Value *> Chain, BoUpSLP &R,
           << "\n");
     ArrayRef<Value *> Operands = Chain.slice(i, VF);
 
+    if (R.isKnownUnprofitableTree(Operands)) {
+      ++NumUnprofitableTreesSkipped;
+      continue;
+    }
+
     R.buildTree(Operands);
     if (R.isTreeTinyAndNotFullyVectorizable())
       continue;
@@ -4154,6 +4275,14 @@ bool SLPVectorizerPass::tryToVectorizeList(ArrayRef<Value *> VL, BoUpSLP &R,
       if (!BuildVector.empty())
         BuildVectorSlice = BuildVector.slice(I, OpsWidth);
 
+      // With reordering allowed a known bad order might still be profitable
+      // the other way around, so only skip exact repeats.
+      if (!AllowReorder && BuildVectorSlice.empty() &&
+          R.isKnownUnprofitableTree(Ops)) {
+        ++NumUnprofitableTreesSkipped;
+        continue;
+      }
+
       R.buildTree(Ops, BuildVectorSlice);
       // TODO: check if we can allow reordering for more cases.
       if (AllowReorder && R.shouldReorder()) {
@@ -13,6 +13,7 @@
 #include "llvm/XRay/Trace.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/XRay/YAMLXRayRecord.h"
@@ -79,14 +80,18 @@ Error loadNaiveFormatLog(StringRef Data, XRayFileHeader &FileHeader,
   //   (8)   uint64 : tsc
   //   (4)   uint32 : thread id
   //   (12)  -      : padding
+  //
+  // The records are decoded straight from the mapped file, and the vector is
+  // sized for all of them up front.
+  Records.reserve(Records.size() + Data.size() / 32 - 1);
   for (auto S = Data.drop_front(32); !S.empty(); S = S.drop_front(32)) {
-    DataExtractor RecordExtractor(S, true, 8);
-    uint32_t OffsetPtr = 0;
+    using namespace support;
+    const uint8_t *P = S.bytes_begin();
     Records.emplace_back();
     auto &Record = Records.back();
-    Record.RecordType = RecordExtractor.getU16(&OffsetPtr);
-    Record.CPU = RecordExtractor.getU8(&OffsetPtr);
-    auto Type = RecordExtractor.getU8(&OffsetPtr);
+    Record.RecordType = endian::read<uint16_t, little, unaligned>(P);
+    Record.CPU = P[2];
+    auto Type = P[3];
     switch (Type) {
     case 0:
       Record.Type = RecordTypes::ENTER;
@@ -99,9 +104,9 @@ Error loadNaiveFormatLog(StringRef Data, XRayFileHeader &FileHeader,
           Twine("Unknown record type '") + Twine(int{Type}) + "'",
           std::make_error_code(std::errc::executable_format_error));
     }
-    Record.FuncId = RecordExtractor.getSigned(&OffsetPtr, sizeof(int32_t));
-    Record.TSC = RecordExtractor.getU64(&OffsetPtr);
-    Record.TId = RecordExtractor.getU32(&OffsetPtr);
+    Record.FuncId = endian::read<int32_t, little, unaligned>(P + 4);
+    Record.TSC = endian::read<uint64_t, little, unaligned>(P + 8);
+    Record.TId = endian::read<uint32_t, little, unaligned>(P + 16);
   }
   return Error::success();
 }
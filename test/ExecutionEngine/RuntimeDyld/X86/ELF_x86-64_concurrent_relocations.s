@@ -0,0 +1,44 @@
+# RUN: llvm-mc -triple=x86_64-pc-linux -filetype=obj -o %T/test_ELF_x86-64_concurrent.o %s
+# RUN: llvm-rtdyld -triple=x86_64-pc-linux -verify -check=%s \
+# RUN:   -rtdyld-concurrent-relocation-threshold=1 \
+# RUN:   -map-section test_ELF_x86-64_concurrent.o,.data.a=0x10000 \
+# RUN:   -map-section test_ELF_x86-64_concurrent.o,.data.b=0x20000 \
+# RUN:   -map-section test_ELF_x86-64_concurrent.o,.data.c=0x30000 \
+# RUN:   -dummy-extern ext=0x40000 %T/test_ELF_x86-64_concurrent.o
+
+# Test that the relocations of different sections are resolved correctly when
+# they are applied concurrently, for relocations against other sections and
+# local labels. Relocations against the external symbol are still applied
+# serially by resolveExternalSymbols, alongside the concurrent ones.
+
+	.section .data.a,"aw"
+	.globl	a
+	.align	8
+a:
+# rtdyld-check: *{8}a = b
+	.quad	b
+# rtdyld-check: *{8}(a + 8) = ext + 4
+	.quad	ext + 4
+# rtdyld-check: *{4}(a + 16) = (c + 8) - (a + 16)
+	.long	local_c - .
+
+	.section .data.b,"aw"
+	.globl	b
+	.align	8
+b:
+# rtdyld-check: *{8}b = a + 8
+	.quad	a + 8
+# rtdyld-check: *{8}(b + 8) = c + 8
+	.quad	local_c
+# rtdyld-check: *{8}(b + 16) = ext
+	.quad	ext
+
+	.section .data.c,"aw"
+	.globl	c
+	.align	8
+c:
+# rtdyld-check: *{8}c = b + 16
+	.quad	b + 16
+local_c:
+# rtdyld-check: *{8}(c + 8) = a
+	.quad	a
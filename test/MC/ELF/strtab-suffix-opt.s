@@ -1,4 +1,6 @@
 // RUN: llvm-mc -filetype=obj -triple i686-pc-linux-gnu %s -o - | llvm-readobj -symbols | FileCheck %s
+// RUN: llvm-mc -filetype=obj -triple i686-pc-linux-gnu %s -o - -elf-tail-merge-strtab=false \
+// RUN:   | llvm-readobj -symbols | FileCheck %s --check-prefix=NOMERGE
 
 	.text
 	.globl	foobar
@@ -19,3 +21,9 @@ foobar:
 // CHECK:     Name: bar (14)
 // CHECK:     Name: foo (18)
 // CHECK:     Name: foobar (11)
+
+// Without tail merging "bar" is no longer a suffix of "foobar", and the
+// strings are laid out in the order they were added.
+// NOMERGE:     Name: bar (44)
+// NOMERGE:     Name: foo (40)
+// NOMERGE:     Name: foobar (33)
@@ -0,0 +1,36 @@
+; Check that functions with a cold entry only go through the cheap function
+; pipeline when cold function tiering is enabled.
+;
+; RUN: opt -disable-verify -debug-pass-manager -enable-npm-cold-function-tiering \
+; RUN:     -passes='default<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=HOT
+; RUN: opt -disable-verify -debug-pass-manager -enable-npm-cold-function-tiering \
+; RUN:     -passes='default<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=COLD
+; RUN: opt -disable-verify -debug-pass-manager -enable-npm-cold-function-tiering \
+; RUN:     -passes='thinlto<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=COLD
+; RUN: opt -disable-verify -debug-pass-manager \
+; RUN:     -passes='default<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=NOTIER
+
+; HOT: Running pass: GVN on hot
+; HOT: Running pass: SLPVectorizerPass on hot
+
+; COLD-NOT: Running pass: GVN on cold
+; COLD-NOT: Running pass: SLPVectorizerPass on cold
+; COLD: Running pass: ConstantMergePass
+
+; NOTIER: Running pass: GVN on cold
+
+define i32 @hot(i32* %p) {
+entry:
+  %v = load i32, i32* %p
+  ret i32 %v
+}
+
+define i32 @cold(i32* %p) cold {
+entry:
+  %v = load i32, i32* %p
+  ret i32 %v
+}
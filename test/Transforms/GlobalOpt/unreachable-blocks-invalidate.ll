@@ -0,0 +1,21 @@
+; Check that removing the unreachable blocks of a function invalidates its
+; cached analyses that depend on the CFG, not only the dominator tree.
+;
+; RUN: opt < %s -disable-output -debug-pass-manager 2>&1 \
+; RUN:    -passes='function(require<loops>,require<postdomtree>),globalopt' \
+; RUN:    | FileCheck %s
+; CHECK: Running analysis: LoopAnalysis on f
+; CHECK: Running analysis: PostDominatorTreeAnalysis on f
+; CHECK: Running pass: GlobalOptPass
+; CHECK: Invalidating all non-preserved analyses for: f
+; CHECK-DAG: Invalidating analysis: LoopAnalysis on f
+; CHECK-DAG: Invalidating analysis: PostDominatorTreeAnalysis on f
+; CHECK: Invalidating all non-preserved analyses for: <stdin>
+
+define void @f() {
+entry:
+  ret void
+
+dead:
+  br label %dead
+}
@@ -0,0 +1,31 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -S -mtriple=x86_64-unknown-linux-gnu -mcpu=corei7 -stats 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The calls to @foo feed two store chains. Their bundle can never be
+; vectorized, so it is scheduled and analyzed for the first chain only and
+; gathered right away when it is reached again from the second chain.
+
+declare double @foo(double) readnone nounwind
+
+; CHECK-LABEL: @two_chains(
+; CHECK: call double @foo(double 1.000000e+00)
+; CHECK: call double @foo(double 2.000000e+00)
+; CHECK-NOT: store <2 x double>
+; CHECK: ret void
+define void @two_chains(double* noalias %a, double* noalias %b) {
+entry:
+  %c0 = call double @foo(double 1.0)
+  %c1 = call double @foo(double 2.0)
+  store double %c0, double* %a, align 8
+  %a1 = getelementptr inbounds double, double* %a, i64 1
+  store double %c1, double* %a1, align 8
+  store double %c0, double* %b, align 8
+  %b1 = getelementptr inbounds double, double* %b, i64 1
+  store double %c1, double* %b1, align 8
+  ret void
+}
+
+; CHECK: {{[0-9]+}} SLP{{.*}}Number of bundles gathered because they were known to be illegal
@@ -0,0 +1,32 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -S -mtriple=x86_64-unknown-linux-gnu -mcpu=corei7 -stats 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Both stores to %p start a chain with the stores to %p1 and %p2, so the
+; roots {%p1, %p2} are reached from both chains. Their stored values are
+; loaded from scattered addresses, which makes the tree unprofitable. It is
+; costed for the first chain only and skipped for the second one, and must
+; still not be vectorized.
+
+; CHECK-LABEL: @shared_tail(
+; CHECK-NOT: <2 x double>
+; CHECK: ret void
+define void @shared_tail(double* noalias %p, double* noalias %q, double %x) {
+entry:
+  %q5 = getelementptr inbounds double, double* %q, i64 5
+  %q9 = getelementptr inbounds double, double* %q, i64 9
+  %l0 = load double, double* %q, align 8
+  %l1 = load double, double* %q5, align 8
+  %l2 = load double, double* %q9, align 8
+  %p1 = getelementptr inbounds double, double* %p, i64 1
+  %p2 = getelementptr inbounds double, double* %p, i64 2
+  store double %l0, double* %p, align 8
+  store double %x, double* %p, align 8
+  store double %l1, double* %p1, align 8
+  store double %l2, double* %p2, align 8
+  ret void
+}
+
+; CHECK: {{[0-9]+}} SLP{{.*}}Number of trees not built because their roots were known to be unprofitable
@@ -0,0 +1,49 @@
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=2 -S | FileCheck %s
+; RUN: opt < %s -passes=sroa -sroa-max-alloca-slices=2 -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i32:32:32-i64:64:64-n8:16:32:64"
+
+define i32 @split_over_budget(i32 %x, i32 %y) {
+; An alloca with more slices than the budget is left alone.
+; CHECK-LABEL: @split_over_budget(
+; CHECK: alloca [2 x i32]
+; CHECK: ret i32
+entry:
+  %a = alloca [2 x i32]
+  %a0 = getelementptr [2 x i32], [2 x i32]* %a, i64 0, i64 0
+  %a1 = getelementptr [2 x i32], [2 x i32]* %a, i64 0, i64 1
+  store i32 %x, i32* %a0
+  store i32 %y, i32* %a1
+  %v0 = load i32, i32* %a0
+  %v1 = load i32, i32* %a1
+  %r = add i32 %v0, %v1
+  ret i32 %r
+}
+
+define i32 @promote_over_budget(i32 %x, i32 %y) {
+; An alloca over the budget is still promoted when it needs no splitting.
+; CHECK-LABEL: @promote_over_budget(
+; CHECK-NOT: alloca
+; CHECK: %[[R:.*]] = add i32 %x, %y
+; CHECK: ret i32 %[[R]]
+entry:
+  %a = alloca i32
+  store i32 %x, i32* %a
+  %v0 = load i32, i32* %a
+  store i32 %y, i32* %a
+  %v1 = load i32, i32* %a
+  %r = add i32 %v0, %v1
+  ret i32 %r
+}
+
+define i32 @within_budget(i32 %x, i32 %y) {
+; CHECK-LABEL: @within_budget(
+; CHECK-NOT: alloca
+; CHECK: ret i32 %y
+entry:
+  %a = alloca [2 x i32]
+  %a1 = getelementptr [2 x i32], [2 x i32]* %a, i64 0, i64 1
+  store i32 %y, i32* %a1
+  %v1 = load i32, i32* %a1
+  ret i32 %v1
+}
@@ -35,6 +35,7 @@
 #include "llvm/Object/MachO.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include <memory>
@@ -1420,10 +1421,35 @@ private:
   /// @{
   bool createStreamer(const Triple &TheTriple, StringRef OutputFilename);
 
+  /// Get the object file of \p Obj for the architecture of \p Map from
+  /// \p BinaryHolder. Doesn't report errors.
+  static ErrorOr<const object::ObjectFile &>
+  getObjectFile(BinaryHolder &BinaryHolder, const DebugMapObject &Obj,
+                const DebugMap &Map);
+
   /// Attempt to load a debug object from disk.
   ErrorOr<const object::ObjectFile &> loadObject(BinaryHolder &BinaryHolder,
                                                  DebugMapObject &Obj,
                                                  const DebugMap &Map);
+
+  /// A debug map object along with its loaded object file and debug info.
+  struct LinkContext {
+    DebugMapObject &DMO;
+    /// Holds the object file when it is loaded on a worker thread.
+    BinaryHolder BinHolder;
+    const object::ObjectFile *ObjectFile = nullptr;
+    std::error_code LoadError;
+    std::unique_ptr<DWARFContext> DwarfContext;
+
+    LinkContext(DebugMapObject &DMO) : DMO(DMO), BinHolder(false) {}
+  };
+
+  /// Load the object file of \p Context from \p BinaryHolder and read in
+  /// all of its debug information entries. This doesn't touch the linker
+  /// state, so it can run concurrently for objects using distinct holders.
+  /// Errors are recorded in the context and reported by the caller.
+  static void loadDebugObject(LinkContext &Context, BinaryHolder &BinaryHolder,
+                              const DebugMap &Map);
   /// @}
 
   std::string OutputFilename;
@@ -3258,20 +3284,41 @@ bool DwarfLinker::registerModuleReference(
 }
 
 ErrorOr<const object::ObjectFile &>
-DwarfLinker::loadObject(BinaryHolder &BinaryHolder, DebugMapObject &Obj,
-                        const DebugMap &Map) {
+DwarfLinker::getObjectFile(BinaryHolder &BinaryHolder,
+                           const DebugMapObject &Obj, const DebugMap &Map) {
   auto ErrOrObjs =
       BinaryHolder.GetObjectFiles(Obj.getObjectFilename(), Obj.getTimestamp());
-  if (std::error_code EC = ErrOrObjs.getError()) {
-    reportWarning(Twine(Obj.getObjectFilename()) + ": " + EC.message());
+  if (std::error_code EC = ErrOrObjs.getError())
     return EC;
-  }
-  auto ErrOrObj = BinaryHolder.Get(Map.getTriple());
+  return BinaryHolder.Get(Map.getTriple());
+}
+
+ErrorOr<const object::ObjectFile &>
+DwarfLinker::loadObject(BinaryHolder &BinaryHolder, DebugMapObject &Obj,
+                        const DebugMap &Map) {
+  auto ErrOrObj = getObjectFile(BinaryHolder, Obj, Map);
   if (std::error_code EC = ErrOrObj.getError())
     reportWarning(Twine(Obj.getObjectFilename()) + ": " + EC.message());
   return ErrOrObj;
 }
 
+void DwarfLinker::loadDebugObject(LinkContext &Context,
+                                  BinaryHolder &BinaryHolder,
+                                  const DebugMap &Map) {
+  auto ErrOrObj = getObjectFile(BinaryHolder, Context.DMO, Map);
+  if (std::error_code EC = ErrOrObj.getError()) {
+    Context.LoadError = EC;
+    return;
+  }
+  Context.ObjectFile = &*ErrOrObj;
+
+  // Parsing the DIEs is the expensive part of reading the debug info, do it
+  // here rather than lazily while the object is being linked.
+  Context.DwarfContext = DWARFContext::create(*Context.ObjectFile);
+  for (const auto &CU : Context.DwarfContext->compile_units())
+    CU->getUnitDIE(false);
+}
+
 void DwarfLinker::loadClangModule(StringRef Filename, StringRef ModulePath,
                                   StringRef ModuleName, uint64_t DwoId,
                                   DebugMap &ModuleMap, unsigned Indent) {
@@ -3418,25 +3465,63 @@ bool DwarfLinker::link(const DebugMap &Map) {
   UnitID = 0;
   DebugMap ModuleMap(Map.getTriple(), Map.getBinaryPath());
 
-  for (const auto &Obj : Map.objects()) {
-    CurrentDebugObject = Obj.get();
+  // Loading an object file and parsing its debug info doesn't depend on the
+  // other objects, so when several threads are available this is done on a
+  // thread pool for the next objects of the debug map while the current one
+  // is being linked. Everything else updates state shared across objects (the
+  // string pool, the ODR contexts, the output sections) and still happens one
+  // object at a time in debug map order, so the output doesn't depend on the
+  // number of threads. Verbose output is interleaved with the loading, hence
+  // it forces a serial link.
+  std::vector<std::unique_ptr<LinkContext>> Contexts;
+  for (const auto &Obj : Map.objects())
+    Contexts.push_back(llvm::make_unique<LinkContext>(*Obj));
+
+  unsigned NumThreads = Options.Verbose ? 1 : Options.NumThreads;
+  std::unique_ptr<ThreadPool> Pool;
+  std::vector<std::shared_future<void>> Loaded(Contexts.size());
+  size_t NextToLoad = 0;
+  if (NumThreads > 1)
+    Pool = llvm::make_unique<ThreadPool>(NumThreads);
+
+  for (size_t I = 0, E = Contexts.size(); I != E; ++I) {
+    CurrentDebugObject = &Contexts[I]->DMO;
+    DebugMapObject *Obj = CurrentDebugObject;
 
     if (Options.Verbose)
       outs() << "DEBUG MAP OBJECT: " << Obj->getObjectFilename() << "\n";
-    auto ErrOrObj = loadObject(BinHolder, *Obj, Map);
-    if (!ErrOrObj)
+
+    if (Pool) {
+      // Keep at most NumThreads objects loaded ahead to bound memory usage.
+      for (; NextToLoad != E && NextToLoad < I + NumThreads; ++NextToLoad) {
+        LinkContext &Next = *Contexts[NextToLoad];
+        Loaded[NextToLoad] = Pool->async(
+            [&Next, &Map] { loadDebugObject(Next, Next.BinHolder, Map); });
+      }
+      Loaded[I].wait();
+    } else {
+      loadDebugObject(*Contexts[I], BinHolder, Map);
+    }
+
+    // The context is released at the end of the iteration, after the object
+    // has been linked.
+    std::unique_ptr<LinkContext> Context = std::move(Contexts[I]);
+    if (Context->LoadError) {
+      reportWarning(Twine(Obj->getObjectFilename()) + ": " +
+                    Context->LoadError.message());
       continue;
+    }
 
     // Look for relocations that correspond to debug map entries.
     RelocationManager RelocMgr(*this);
-    if (!RelocMgr.findValidRelocsInDebugInfo(*ErrOrObj, *Obj)) {
+    if (!RelocMgr.findValidRelocsInDebugInfo(*Context->ObjectFile, *Obj)) {
       if (Options.Verbose)
         outs() << "No valid relocations found. Skipping.\n";
       continue;
     }
 
     // Setup access to the debug info.
-    auto DwarfContext = DWARFContext::create(*ErrOrObj);
+    auto &DwarfContext = Context->DwarfContext;
     startDebugObject(*DwarfContext, *Obj);
 
     // In a first phase, just read in the debug info and load all clang modules.
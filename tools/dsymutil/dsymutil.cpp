@@ -22,6 +22,7 @@
 #include "llvm/Support/Options.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
 #include <cstdint>
@@ -82,6 +83,15 @@ static opt<bool>
           desc("Do not use ODR (One Definition Rule) for type uniquing."),
           init(false), cat(DsymCategory));
 
+static opt<unsigned> NumThreads(
+    "num-threads",
+    desc("Specifies the maximum number (n) of simultaneous threads to use\n"
+         "when loading and parsing the object files of the debug map.\n"
+         "Defaults to the number of cores."),
+    value_desc("n"), init(0), cat(DsymCategory));
+static alias NumThreadsA("j", desc("Alias for --num-threads"),
+                         aliasopt(NumThreads));
+
 static opt<bool> DumpDebugMap(
     "dump-debug-map",
     desc("Parse and dump the debug map to standard output. Not DWARF link "
@@ -265,6 +275,8 @@ int main(int argc, char **argv) {
   Options.NoOutput = NoOutput;
   Options.NoODR = NoODR;
   Options.PrependPath = OsoPrependPath;
+  Options.NumThreads =
+      NumThreads ? NumThreads : llvm::heavyweight_hardware_concurrency();
 
   llvm::InitializeAllTargetInfos();
   llvm::InitializeAllTargetMCs();
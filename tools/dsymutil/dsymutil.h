@@ -29,8 +29,9 @@ struct LinkOptions {
   bool NoOutput; ///< Skip emitting output
   bool NoODR;    ///< Do not unique types according to ODR
   std::string PrependPath; ///< -oso-prepend-path
+  unsigned NumThreads;     ///< Threads used to load the object files
 
-  LinkOptions() : Verbose(false), NoOutput(false) {}
+  LinkOptions() : Verbose(false), NoOutput(false), NumThreads(1) {}
 };
 
 /// \brief Extract the DebugMaps from the given file.
@@ -86,6 +86,11 @@ static cl::opt<bool> Quiet("quiet",
 
 static cl::opt<bool> Brief("brief", cl::desc("Print fewer low-level details"));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(1),
+               cl::desc("Parse the compile units upfront on this many threads "
+                        "(0 uses one per core)"));
+
 static void error(StringRef Filename, std::error_code EC) {
   if (!EC)
     return;
@@ -94,7 +99,9 @@ static void error(StringRef Filename, std::error_code EC) {
 }
 
 static void DumpObjectFile(ObjectFile &Obj, Twine Filename) {
-  std::unique_ptr<DIContext> DICtx = DWARFContext::create(Obj);
+  std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(Obj);
+  if (NumThreads != 1)
+    DICtx->parseAllUnits(NumThreads);
 
   outs() << Filename.str() << ":\tfile format " << Obj.getFileFormatName()
          << "\n\n";
@@ -131,7 +138,9 @@ static void DumpInput(StringRef Filename) {
 }
 
 static bool VerifyObjectFile(ObjectFile &Obj, Twine Filename) {
-  std::unique_ptr<DIContext> DICtx = DWARFContext::create(Obj);
+  std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(Obj);
+  if (NumThreads != 1)
+    DICtx->parseAllUnits(NumThreads);
 
   // Verify the DWARF and exit with non-zero exit status if verification
   // fails.
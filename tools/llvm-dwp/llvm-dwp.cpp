@@ -14,6 +14,7 @@
 #include "DWPError.h"
 #include "DWPStringPool.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/CodeGen/AsmPrinter.h"
@@ -38,6 +39,8 @@
 #include "llvm/Support/Options.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include <deque>
@@ -57,9 +60,18 @@ static opt<std::string> OutputFilename(Required, "o",
                                        value_desc("filename"),
                                        cat(DwpCategory));
 
+static opt<unsigned> NumThreads(
+    "num-threads",
+    desc("Number of threads used to read the input files, 0 means the "
+         "number of cores. The output doesn't depend on it."),
+    init(0), cat(DwpCategory));
+static alias NumThreadsA("j", desc("Alias for -num-threads"),
+                         aliasopt(NumThreads));
+
 static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
                                    MCSection *StrOffsetSection,
                                    StringRef CurStrSection,
+                                   ArrayRef<CachedHashStringRef> CurStrings,
                                    StringRef CurStrOffsetSection) {
   // Could possibly produce an error or warning if one of these was non-null but
   // the other was null.
@@ -68,16 +80,13 @@ static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
 
   DenseMap<uint32_t, uint32_t> OffsetRemapping;
 
-  DataExtractor Data(CurStrSection, true, 0);
   uint32_t LocalOffset = 0;
-  uint32_t PrevOffset = 0;
-  while (const char *s = Data.getCStr(&LocalOffset)) {
-    OffsetRemapping[PrevOffset] =
-        Strings.getOffset(s, LocalOffset - PrevOffset);
-    PrevOffset = LocalOffset;
+  for (CachedHashStringRef S : CurStrings) {
+    OffsetRemapping[LocalOffset] = Strings.getOffset(S);
+    LocalOffset += S.size() + 1;
   }
 
-  Data = DataExtractor(CurStrOffsetSection, true, 0);
+  DataExtractor Data(CurStrOffsetSection, true, 0);
 
   Out.SwitchSection(StrOffsetSection);
 
@@ -381,36 +390,86 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
-  if (Section.isBSS())
-    return Error::success();
+namespace {
+/// An input file along with the contents of its sections. Input files are
+/// read, their sections decompressed and their strings hashed ahead of the
+/// merge, concurrently.
+struct InputFile {
+  struct Section {
+    /// The section name without its leading dots and underscores.
+    StringRef Name;
+    StringRef Contents;
+  };
+
+  OwningBinary<ObjectFile> Obj;
+  /// The result of reading the file ahead of the merge. Set once the read
+  /// is done; errors of files the merge never reaches are dropped.
+  llvm::Optional<Error> Err;
+  std::vector<Section> Sections;
+  std::deque<SmallString<32>> UncompressedSections;
+  /// The null terminated strings of the string section.
+  std::vector<CachedHashStringRef> Strings;
 
-  if (Section.isVirtual())
-    return Error::success();
+  ~InputFile() {
+    if (Err)
+      consumeError(std::move(*Err));
+  }
+};
+} // end anonymous namespace
+
+static Error readSections(InputFile &Input) {
+  for (const SectionRef &Section : Input.Obj.getBinary()->sections()) {
+    if (Section.isBSS())
+      continue;
+
+    if (Section.isVirtual())
+      continue;
+
+    StringRef Name;
+    if (std::error_code Err = Section.getName(Name))
+      return errorCodeToError(Err);
+
+    StringRef Contents;
+    if (auto Err = Section.getContents(Contents))
+      return errorCodeToError(Err);
 
-  StringRef Name;
-  if (std::error_code Err = Section.getName(Name))
-    return errorCodeToError(Err);
+    if (auto Err =
+            handleCompressedSection(Input.UncompressedSections, Name, Contents))
+      return Err;
 
-  StringRef Contents;
-  if (auto Err = Section.getContents(Contents))
-    return errorCodeToError(Err);
+    Name = Name.substr(Name.find_first_not_of("._"));
+    Input.Sections.push_back({Name, Contents});
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
-    return Err;
+    if (Name == "debug_str.dwo") {
+      Input.Strings.clear();
+      for (size_t End = Contents.find('\0'); End != StringRef::npos;
+           End = Contents.find('\0')) {
+        Input.Strings.push_back(CachedHashStringRef(Contents.take_front(End)));
+        Contents = Contents.drop_front(End + 1);
+      }
+    }
+  }
+  return Error::success();
+}
 
-  Name = Name.substr(Name.find_first_not_of("._"));
+static Error readInputFile(InputFile &Input, StringRef Path) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Path);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+  Input.Obj = std::move(*ErrOrObj);
+  return readSections(Input);
+}
 
+static Error handleSection(
+    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
+    const MCSection *StrSection, const MCSection *StrOffsetSection,
+    const MCSection *TypesSection, const MCSection *CUIndexSection,
+    const MCSection *TUIndexSection, StringRef Name, StringRef Contents,
+    MCStreamer &Out, uint32_t (&ContributionOffsets)[8],
+    UnitIndexEntry &CurEntry, StringRef &CurStrSection,
+    StringRef &CurStrOffsetSection, std::vector<StringRef> &CurTypesSection,
+    StringRef &InfoSection, StringRef &AbbrevSection,
+    StringRef &CurCUIndexSection, StringRef &CurTUIndexSection) {
   auto SectionPair = KnownSections.find(Name);
   if (SectionPair == KnownSections.end())
     return Error::success();
@@ -488,18 +547,40 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
-
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
+  // The index entries refer to the names in the input files, so they are
+  // kept open until the end.
+  std::vector<InputFile> Files(Inputs.size());
+
+  // Read the input files a bounded number ahead of the one being merged. The
+  // merge itself goes through the inputs in order, so the output doesn't
+  // depend on the number of threads. The pool is declared after the input
+  // files so that it waits for its tasks before they are destroyed.
+  unsigned Threads = NumThreads ? NumThreads.getValue()
+                                : heavyweight_hardware_concurrency();
+  std::unique_ptr<ThreadPool> Pool;
+  if (Threads > 1)
+    Pool = llvm::make_unique<ThreadPool>(Threads);
+  std::vector<std::shared_future<void>> Read(Inputs.size());
+  size_t NextToRead = 0;
+
+  for (size_t InputIdx = 0, E = Inputs.size(); InputIdx != E; ++InputIdx) {
+    StringRef Input = Inputs[InputIdx];
+    InputFile &CurInput = Files[InputIdx];
+    if (Pool) {
+      for (; NextToRead != E && NextToRead < InputIdx + Threads; ++NextToRead) {
+        InputFile &Next = Files[NextToRead];
+        StringRef Path = Inputs[NextToRead];
+        Read[NextToRead] = Pool->async(
+            [&Next, Path] { Next.Err.emplace(readInputFile(Next, Path)); });
+      }
+      Read[InputIdx].wait();
+      if (auto Err = std::move(*CurInput.Err))
+        return Err;
+    } else if (auto Err = readInputFile(CurInput, Input)) {
+      return Err;
+    }
 
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+    auto &Obj = *CurInput.Obj.getBinary();
 
     UnitIndexEntry CurEntry = {};
 
@@ -511,20 +592,20 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
+    for (const auto &Section : CurInput.Sections)
       if (auto Err = handleSection(
               KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
+              CUIndexSection, TUIndexSection, Section.Name, Section.Contents,
+              Out, ContributionOffsets, CurEntry, CurStrSection,
+              CurStrOffsetSection, CurTypesSection, InfoSection, AbbrevSection,
+              CurCUIndexSection, CurTUIndexSection))
         return Err;
 
     if (InfoSection.empty())
       continue;
 
     writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
-                           CurStrOffsetSection);
+                           CurInput.Strings, CurStrOffsetSection);
 
     if (CurCUIndexSection.empty()) {
       Expected<CompileUnitIdentifiers> EID = getCUIdentifiers(
@@ -316,7 +316,7 @@ static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 // the darwin format it produces the same output as darwin's nm(1) -m output
 // and when printing Mach-O symbols in hex it produces the same output as
 // darwin's nm(1) -x format.
-static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
+static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol *I,
                               char *SymbolAddrStr, const char *printBlanks,
                               const char *printDashes, const char *printFormat) {
   MachO::mach_header H;
@@ -633,7 +633,7 @@ static const char *getDarwinStabString(uint8_t NType) {
 
 // darwinPrintStab() prints the n_sect, n_desc along with a symbolic name of
 // a stab n_type value in a Mach-O file.
-static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I) {
+static void darwinPrintStab(MachOObjectFile *MachO, const NMSymbol *I) {
   MachO::nlist_64 STE_64;
   MachO::nlist STE;
   uint8_t NType;
@@ -689,6 +689,13 @@ static bool symbolIsDefined(const NMSymbol &Sym) {
 static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
                                    const std::string &ArchiveName,
                                    const std::string &ArchitectureName) {
+  // Sort pointers to the symbols rather than the symbols themselves, which
+  // are much larger.
+  std::vector<const NMSymbol *> Order;
+  Order.reserve(SymbolList.size());
+  for (const NMSymbol &S : SymbolList)
+    Order.push_back(&S);
+
   if (!NoSort) {
     std::function<bool(const NMSymbol &, const NMSymbol &)> Cmp;
     if (NumericSort)
@@ -700,7 +707,8 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
 
     if (ReverseSort)
       Cmp = [=](const NMSymbol &A, const NMSymbol &B) { return Cmp(B, A); };
-    std::sort(SymbolList.begin(), SymbolList.end(), Cmp);
+    std::sort(Order.begin(), Order.end(),
+              [&](const NMSymbol *A, const NMSymbol *B) { return Cmp(*A, *B); });
   }
 
   if (!PrintFileName) {
@@ -744,8 +752,7 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
     }
   }
 
-  for (SymbolListT::iterator I = SymbolList.begin(), E = SymbolList.end();
-       I != E; ++I) {
+  for (const NMSymbol *I : Order) {
     uint32_t SymFlags;
     std::string Name = I->Name.str();
     MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(&Obj);
@@ -1123,6 +1130,8 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
   }
   std::string NameBuffer;
   raw_string_ostream OS(NameBuffer);
+  // Indices of the symbols whose names were printed into NameBuffer.
+  std::vector<size_t> CopiedNames;
   // If a "-s segname sectname" option was specified and this is a Mach-O
   // file get the section number for that section in this object file.
   unsigned int Nsect = 0;
@@ -1163,24 +1172,37 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
         S.Address = *AddressOrErr;
       }
       S.TypeChar = getNMTypeChar(Obj, Sym);
-      std::error_code EC = Sym.printName(OS);
-      if (EC && MachO)
-        OS << "bad string index";
-      else
-        error(EC);
-      OS << '\0';
       S.Sym = Sym;
+      if (isa<ObjectFile>(Obj)) {
+        // The names of object file symbols live in the mapped file, refer to
+        // them there instead of copying them.
+        Expected<StringRef> NameOrErr = SymbolRef(Sym).getName();
+        if (NameOrErr) {
+          S.Name = *NameOrErr;
+        } else {
+          std::error_code EC = errorToErrorCode(NameOrErr.takeError());
+          if (MachO)
+            S.Name = "bad string index";
+          else
+            error(EC);
+        }
+      } else {
+        error(Sym.printName(OS));
+        OS << '\0';
+        CopiedNames.push_back(SymbolList.size());
+      }
       SymbolList.push_back(S);
     }
   }
 
   OS.flush();
   const char *P = NameBuffer.c_str();
-  unsigned I;
-  for (I = 0; I < SymbolList.size(); ++I) {
-    SymbolList[I].Name = P;
+  for (size_t Idx : CopiedNames) {
+    SymbolList[Idx].Name = P;
     P += strlen(P) + 1;
   }
+  // The symbols faked up from the dyld info below are named starting at I.
+  unsigned I = SymbolList.size();
 
   // If this is a Mach-O file where the nlist symbol table is out of sync
   // with the dyld export trie then look through exports and fake up symbols
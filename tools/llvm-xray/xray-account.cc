@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <numeric>
 #include <system_error>
@@ -21,6 +22,8 @@
 #include "xray-registry.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/XRay/InstrumentationMap.h"
 #include "llvm/XRay/Trace.h"
 
@@ -45,6 +48,14 @@ static cl::alias
     AccountDeduceSiblingCalls2("d", cl::aliasopt(AccountDeduceSiblingCalls),
                                cl::desc("Alias for -deduce_sibling_calls"),
                                cl::sub(Account));
+static cl::opt<unsigned> AccountThreads(
+    "threads",
+    cl::desc("Number of threads accounting the records of different thread "
+             "IDs, 0 means the number of cores"),
+    cl::sub(Account), cl::init(0));
+static cl::alias AccountThreads2("j", cl::aliasopt(AccountThreads),
+                                 cl::desc("Alias for -threads"),
+                                 cl::sub(Account));
 static cl::opt<std::string>
     AccountOutput("output", cl::value_desc("output file"), cl::init("-"),
                   cl::desc("output file; use '-' for stdout"),
@@ -212,6 +223,69 @@ bool LatencyAccountant::accountRecord(const XRayRecord &Record) {
   return true;
 }
 
+bool LatencyAccountant::accountRecordsInParallel(const Trace &T,
+                                                 unsigned NumThreads) {
+  if (T.size() == 0)
+    return true;
+
+  // Split the records by thread ID, keeping them in trace order. The
+  // partitions are ordered by the first record of their thread. Thread IDs
+  // come from the trace and can take any value, so they aren't DenseMap keys.
+  std::unordered_map<uint32_t, unsigned> PartitionIndex;
+  std::vector<std::vector<const XRayRecord *>> Partitions;
+  for (const XRayRecord &Record : T) {
+    auto P = PartitionIndex.insert(
+        std::make_pair(Record.TId, unsigned(Partitions.size())));
+    if (P.second)
+      Partitions.emplace_back();
+    Partitions[P.first->second].push_back(&Record);
+  }
+
+  // A record is only rejected for its TSC when it comes before the first
+  // record of the trace, so each partition can check against that.
+  uint64_t FirstTSC = T.begin()->TSC;
+  std::vector<std::unique_ptr<LatencyAccountant>> Accountants;
+  for (size_t I = 0, E = Partitions.size(); I != E; ++I) {
+    Accountants.push_back(
+        llvm::make_unique<LatencyAccountant>(FuncIdHelper, DeduceSiblingCalls));
+    Accountants.back()->CurrentMaxTSC = FirstTSC;
+  }
+
+  std::atomic<bool> Failed(false);
+  {
+    ThreadPool Pool(std::min<size_t>(NumThreads, Partitions.size()));
+    for (size_t I = 0, E = Partitions.size(); I != E; ++I)
+      Pool.async([&, I] {
+        for (const XRayRecord *Record : Partitions[I])
+          if (!Accountants[I]->accountRecord(*Record)) {
+            Failed = true;
+            return;
+          }
+      });
+    Pool.wait();
+  }
+  if (Failed)
+    return false;
+
+  // The per-CPU ranges depend on the order of the records across threads,
+  // compute them here rather than merging them.
+  for (const XRayRecord &Record : T)
+    setMinMax(PerCPUMinMaxTSC[Record.CPU], Record.TSC);
+  CurrentMaxTSC = FirstTSC;
+
+  for (size_t I = 0, E = Partitions.size(); I != E; ++I) {
+    LatencyAccountant &A = *Accountants[I];
+    auto TId = Partitions[I].front()->TId;
+    PerThreadMinMaxTSC[TId] = A.PerThreadMinMaxTSC[TId];
+    PerThreadFunctionStack[TId] = std::move(A.PerThreadFunctionStack[TId]);
+    for (auto &FL : A.FunctionLatencies) {
+      auto &Latencies = FunctionLatencies[FL.first];
+      Latencies.insert(Latencies.end(), FL.second.begin(), FL.second.end());
+    }
+  }
+  return true;
+}
+
 namespace {
 
 // We consolidate the data into a struct which we can output in various forms.
@@ -230,7 +304,9 @@ struct ResultRow {
 ResultRow getStats(std::vector<uint64_t> &Timings) {
   assert(!Timings.empty());
   ResultRow R;
-  R.Sum = std::accumulate(Timings.begin(), Timings.end(), 0.0);
+  // Sum the latencies as integers so that the result doesn't depend on the
+  // order they were recorded in.
+  R.Sum = std::accumulate(Timings.begin(), Timings.end(), uint64_t(0));
   auto MinMax = std::minmax_element(Timings.begin(), Timings.end());
   R.Min = *MinMax.first;
   R.Max = *MinMax.second;
@@ -273,6 +349,13 @@ void LatencyAccountant::exportStats(const XRayFileHeader &Header, F Fn) const {
     Row.DebugInfo = FuncIdHelper.FileLineAndColumn(FuncId);
   }
 
+  // The latencies are kept in a hash map. Order the results by function id
+  // first so that the output doesn't depend on its iteration order.
+  std::sort(Results.begin(), Results.end(),
+            [](const TupleType &L, const TupleType &R) {
+              return std::get<0>(L) < std::get<0>(R);
+            });
+
   // Sort the data according to user-provided flags.
   switch (AccountSortOutput) {
   case SortField::FUNCID:
@@ -442,21 +525,28 @@ static CommandRegistration Unused(&Account, []() -> Error {
         TraceOrErr.takeError());
 
   auto &T = *TraceOrErr;
-  for (const auto &Record : T) {
-    if (FCA.accountRecord(Record))
-      continue;
-    for (const auto &ThreadStack : FCA.getPerThreadFunctionStack()) {
-      errs() << "Thread ID: " << ThreadStack.first << "\n";
-      auto Level = ThreadStack.second.size();
-      for (const auto &Entry : llvm::reverse(ThreadStack.second))
-        errs() << "#" << Level-- << "\t"
-               << FuncIdHelper.SymbolOrNumber(Entry.first) << '\n';
+  unsigned NumThreads =
+      AccountThreads ? AccountThreads : heavyweight_hardware_concurrency();
+  // Account the records one by one if that can't be done in parallel or if
+  // it fails, which reports the stacks of all threads at the first record
+  // that can't be accounted.
+  if (NumThreads <= 1 || !FCA.accountRecordsInParallel(T, NumThreads)) {
+    for (const auto &Record : T) {
+      if (FCA.accountRecord(Record))
+        continue;
+      for (const auto &ThreadStack : FCA.getPerThreadFunctionStack()) {
+        errs() << "Thread ID: " << ThreadStack.first << "\n";
+        auto Level = ThreadStack.second.size();
+        for (const auto &Entry : llvm::reverse(ThreadStack.second))
+          errs() << "#" << Level-- << "\t"
+                 << FuncIdHelper.SymbolOrNumber(Entry.first) << '\n';
+      }
+      if (!AccountKeepGoing)
+        return make_error<StringError>(
+            Twine("Failed accounting function calls in file '") + AccountInput +
+                "'.",
+            std::make_error_code(std::errc::executable_format_error));
     }
-    if (!AccountKeepGoing)
-      return make_error<StringError>(
-          Twine("Failed accounting function calls in file '") + AccountInput +
-              "'.",
-          std::make_error_code(std::errc::executable_format_error));
   }
   switch (AccountOutputFormat) {
   case AccountOutputFormats::TEXT:
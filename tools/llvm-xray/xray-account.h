@@ -15,12 +15,14 @@
 #define LLVM_TOOLS_LLVM_XRAY_XRAY_ACCOUNT_H
 
 #include <map>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "func-id-helper.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/XRay/Trace.h"
 #include "llvm/XRay/XRayRecord.h"
 
 namespace llvm {
@@ -28,7 +30,11 @@ namespace xray {
 
 class LatencyAccountant {
 public:
-  typedef std::map<int32_t, std::vector<uint64_t>> FunctionLatencyMap;
+  /// Latencies are recorded for every exit record, so this is a hash map
+  /// rather than a tree. Function ids from a trace can take any value,
+  /// including the empty and tombstone keys of a DenseMap.
+  typedef std::unordered_map<int32_t, std::vector<uint64_t>>
+      FunctionLatencyMap;
   typedef std::map<llvm::sys::ProcessInfo::ProcessId,
                    std::pair<uint64_t, uint64_t>>
       PerThreadMinMaxTSCMap;
@@ -79,6 +85,13 @@ public:
   ///
   bool accountRecord(const XRayRecord &Record);
 
+  /// Account all the records of \p T, the records of each thread on one of
+  /// \p NumThreads threads. The results are the same as accounting the
+  /// records one by one. Returns false, without accounting anything, if any
+  /// record fails to be accounted; the caller is expected to account the
+  /// records one by one then to diagnose the failure.
+  bool accountRecordsInParallel(const Trace &T, unsigned NumThreads);
+
   const FunctionStack *
   getThreadFunctionStack(llvm::sys::ProcessInfo::ProcessId TId) const {
     auto I = PerThreadFunctionStack.find(TId);
@@ -0,0 +1,119 @@
+//===- SymbolizationIndexTest.cpp -----------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/Symbolize/SymbolizationIndex.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::symbolize;
+
+namespace {
+
+class SymbolizationIndexTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("SymbolizationIndexTest", TestDir));
+    IndexPath = TestDir;
+    sys::path::append(IndexPath, "index");
+  }
+
+  void TearDown() override {
+    sys::fs::remove(IndexPath);
+    sys::fs::remove(TestDir);
+  }
+
+  static DIInliningInfo makeInfo(StringRef Function, uint32_t Line) {
+    DILineInfo Inlined;
+    Inlined.FunctionName = Function.str() + "_inlined";
+    Inlined.FileName = "inlined.h";
+    Inlined.Line = Line;
+    Inlined.Column = 3;
+    Inlined.StartLine = 1;
+    Inlined.Discriminator = 2;
+    DILineInfo Caller;
+    Caller.FunctionName = Function;
+    Caller.FileName = "caller.cpp";
+    Caller.Line = Line + 100;
+    Caller.Column = 5;
+    Caller.StartLine = 4;
+    DIInliningInfo Info;
+    Info.addFrame(Inlined);
+    Info.addFrame(Caller);
+    return Info;
+  }
+
+  static void expectInfo(const Optional<DIInliningInfo> &Actual,
+                         const DIInliningInfo &Expected) {
+    ASSERT_TRUE(Actual.hasValue());
+    ASSERT_EQ(Expected.getNumberOfFrames(), Actual->getNumberOfFrames());
+    for (uint32_t I = 0, N = Expected.getNumberOfFrames(); I != N; ++I) {
+      EXPECT_EQ(Expected.getFrame(I), Actual->getFrame(I));
+      EXPECT_EQ(Expected.getFrame(I).StartLine, Actual->getFrame(I).StartLine);
+      EXPECT_EQ(Expected.getFrame(I).Discriminator,
+                Actual->getFrame(I).Discriminator);
+    }
+  }
+
+  SmallString<128> TestDir;
+  SmallString<128> IndexPath;
+};
+
+TEST_F(SymbolizationIndexTest, ReadBack) {
+  DIInliningInfo Info = makeInfo("foo", 10);
+  {
+    SymbolizationIndex Index(IndexPath.str(), /*Flags=*/1);
+    EXPECT_FALSE(Index.lookup(0x1000).hasValue());
+    Index.insert(0x1000, Info);
+    EXPECT_THAT_ERROR(Index.write(), Succeeded());
+  }
+
+  SymbolizationIndex Index(IndexPath.str(), /*Flags=*/1);
+  expectInfo(Index.lookup(0x1000), Info);
+  EXPECT_FALSE(Index.lookup(0x1001).hasValue());
+  EXPECT_FALSE(Index.lookup(0xfff).hasValue());
+}
+
+TEST_F(SymbolizationIndexTest, MergeWriters) {
+  DIInliningInfo Foo = makeInfo("foo", 10);
+  DIInliningInfo Bar = makeInfo("bar", 20);
+  DIInliningInfo Baz = makeInfo("baz", 30);
+
+  // Both indexes are opened before either is written, like two symbolizers
+  // running at the same time.
+  SymbolizationIndex First(IndexPath.str(), /*Flags=*/1);
+  SymbolizationIndex Second(IndexPath.str(), /*Flags=*/1);
+  First.insert(0x1000, Foo);
+  First.insert(0x3000, Baz);
+  Second.insert(0x2000, Bar);
+  EXPECT_THAT_ERROR(First.write(), Succeeded());
+  EXPECT_THAT_ERROR(Second.write(), Succeeded());
+
+  SymbolizationIndex Index(IndexPath.str(), /*Flags=*/1);
+  expectInfo(Index.lookup(0x1000), Foo);
+  expectInfo(Index.lookup(0x2000), Bar);
+  expectInfo(Index.lookup(0x3000), Baz);
+}
+
+TEST_F(SymbolizationIndexTest, MismatchedFlags) {
+  {
+    SymbolizationIndex Index(IndexPath.str(), /*Flags=*/1);
+    Index.insert(0x1000, makeInfo("foo", 10));
+    EXPECT_THAT_ERROR(Index.write(), Succeeded());
+  }
+
+  SymbolizationIndex Index(IndexPath.str(), /*Flags=*/2);
+  EXPECT_FALSE(Index.lookup(0x1000).hasValue());
+}
+
+} // end anonymous namespace
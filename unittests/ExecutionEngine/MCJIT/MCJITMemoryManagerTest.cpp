@@ -166,5 +166,50 @@ TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   }
 }
 
+TEST(MCJITMemoryManagerTest, RecyclingMemoryMapper) {
+  RecyclingMemoryMapper Mapper;
+  uint8_t *code1, *data1, *code2, *data2;
+  {
+    SectionMemoryManager MemMgr(&Mapper);
+    code1 = MemMgr.allocateCodeSection(256, 0, 1, "");
+    data1 = MemMgr.allocateDataSection(256, 0, 2, "", false);
+    EXPECT_NE((uint8_t*)nullptr, code1);
+    EXPECT_NE((uint8_t*)nullptr, data1);
+    std::string Error;
+    EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+    EXPECT_EQ(0U, Mapper.getCachedBytes());
+  }
+  // The slabs of the destroyed memory manager are kept...
+  EXPECT_NE(0U, Mapper.getCachedBytes());
+  {
+    // ...and handed out again, writable.
+    SectionMemoryManager MemMgr(&Mapper);
+    code2 = MemMgr.allocateCodeSection(256, 0, 1, "");
+    data2 = MemMgr.allocateDataSection(256, 0, 2, "", false);
+    EXPECT_EQ(0U, Mapper.getCachedBytes());
+    EXPECT_TRUE(code2 == code1 || code2 == data1);
+    EXPECT_TRUE(data2 == code1 || data2 == data1);
+    for (unsigned i = 0; i < 256; ++i) {
+      code2[i] = 1;
+      data2[i] = 2;
+    }
+    for (unsigned i = 0; i < 256; ++i) {
+      EXPECT_EQ(1, code2[i]);
+      EXPECT_EQ(2, data2[i]);
+    }
+    std::string Error;
+    EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+  }
+
+  // Large allocations bypass the mapper's cache.
+  size_t CachedBytes = Mapper.getCachedBytes();
+  {
+    SectionMemoryManager MemMgr(&Mapper);
+    uint8_t *code3 = MemMgr.allocateCodeSection(0x200000, 0, 1, "");
+    EXPECT_NE((uint8_t*)nullptr, code3);
+  }
+  EXPECT_EQ(CachedBytes, Mapper.getCachedBytes());
+}
+
 } // Namespace
 
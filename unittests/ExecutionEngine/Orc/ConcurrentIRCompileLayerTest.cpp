@@ -0,0 +1,186 @@
+//===- ConcurrentIRCompileLayerTest.cpp - Unit tests for the compile layer ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/ConcurrentIRCompileLayer.h"
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/NullResolver.h"
+#include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "gtest/gtest.h"
+#include <functional>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+// Object layer recording the "objects" (the names of the compiled modules)
+// added to it.
+struct MockObjectLayer {
+  using ObjHandleT = unsigned;
+
+  Expected<ObjHandleT> addObject(std::shared_ptr<std::string> Obj,
+                                 std::shared_ptr<JITSymbolResolver>) {
+    Objects.push_back(*Obj);
+    return Objects.size() - 1;
+  }
+
+  Error removeObject(ObjHandleT H) {
+    Removed.push_back(H);
+    return Error::success();
+  }
+
+  JITSymbol findSymbol(const std::string &Name, bool ExportedSymbolsOnly) {
+    return nullptr;
+  }
+
+  JITSymbol findSymbolIn(ObjHandleT H, const std::string &Name,
+                         bool ExportedSymbolsOnly) {
+    // Encode the handle in the address.
+    return JITSymbol(0x1000 + H, JITSymbolFlags::Exported);
+  }
+
+  Error emitAndFinalize(ObjHandleT H) {
+    Finalized.push_back(H);
+    return Error::success();
+  }
+
+  std::vector<std::string> Objects;
+  std::vector<ObjHandleT> Removed;
+  std::vector<ObjHandleT> Finalized;
+};
+
+using CompileFtor = std::function<std::string(Module &)>;
+
+std::shared_ptr<Module> createModule(LLVMContext &Context, StringRef Name,
+                                     StringRef FuncName) {
+  ModuleBuilder MB(Context, "", Name);
+  Function *F = MB.createFunctionDecl<void()>(FuncName);
+  ReturnInst::Create(Context, BasicBlock::Create(Context, "entry", F));
+  return MB.takeModule();
+}
+
+TEST(ConcurrentIRCompileLayerTest, LazyAdd) {
+  MockObjectLayer BaseLayer;
+  ConcurrentIRCompileLayer<MockObjectLayer, CompileFtor> CompileLayer(
+      BaseLayer, [](Module &M) { return M.getModuleIdentifier(); });
+
+  LLVMContext Context;
+  auto H = cantFail(
+      CompileLayer.addModule(createModule(Context, "M", "foo"), nullptr));
+  EXPECT_FALSE(CompileLayer.findSymbol("bar", false))
+      << "Found a symbol that is not defined";
+
+  auto Sym = CompileLayer.findSymbol("foo", false);
+  EXPECT_TRUE(!!Sym) << "Did not find the symbol of the compiling module";
+  EXPECT_TRUE(BaseLayer.Objects.empty())
+      << "Object added before its address was requested";
+  EXPECT_EQ(cantFail(Sym.getAddress()), 0x1000U);
+  ASSERT_EQ(BaseLayer.Objects.size(), 1U);
+  EXPECT_EQ(BaseLayer.Objects[0], "M");
+
+  cantFail(CompileLayer.removeModule(H));
+  EXPECT_EQ(BaseLayer.Removed, std::vector<unsigned>{0});
+}
+
+TEST(ConcurrentIRCompileLayerTest, ManyModules) {
+  MockObjectLayer BaseLayer;
+  ConcurrentIRCompileLayer<MockObjectLayer, CompileFtor> CompileLayer(
+      BaseLayer, [](Module &M) { return M.getModuleIdentifier(); }, 4);
+
+  // Every module has its own context, so that they can be compiled at the
+  // same time.
+  const unsigned NumModules = 16;
+  std::vector<std::unique_ptr<LLVMContext>> Contexts;
+  using ModuleHandleT = decltype(CompileLayer)::ModuleHandleT;
+  std::vector<ModuleHandleT> Handles;
+  for (unsigned I = 0; I != NumModules; ++I) {
+    Contexts.push_back(llvm::make_unique<LLVMContext>());
+    std::string Name = "M" + std::to_string(I);
+    Handles.push_back(cantFail(CompileLayer.addModule(
+        createModule(*Contexts.back(), Name, "f" + std::to_string(I)),
+        nullptr)));
+  }
+
+  // Emit the modules in reverse order.
+  for (unsigned I = NumModules; I != 0; --I)
+    cantFail(CompileLayer.emitAndFinalize(Handles[I - 1]));
+  ASSERT_EQ(BaseLayer.Objects.size(), NumModules);
+  for (unsigned I = 0; I != NumModules; ++I)
+    EXPECT_EQ(BaseLayer.Objects[I], "M" + std::to_string(NumModules - 1 - I));
+  EXPECT_EQ(BaseLayer.Finalized.size(), NumModules);
+
+  // Symbols of emitted modules are looked up in the base layer.
+  auto Sym = CompileLayer.findSymbolIn(Handles[0], "f0", false);
+  EXPECT_EQ(cantFail(Sym.getAddress()), 0x1000U + NumModules - 1);
+}
+
+class ConcurrentIRCompileLayerExecutionTest : public testing::Test,
+                                              public OrcExecutionTest {};
+
+TEST_F(ConcurrentIRCompileLayerExecutionTest, ConcurrentIRCompiler) {
+  if (!TM)
+    return;
+
+  // The factory is called from the compile threads. Creating TargetMachines
+  // from a Target is thread-safe.
+  const Target &T = TM->getTarget();
+  std::string TT = TM->getTargetTriple().str();
+  std::string CPU = TM->getTargetCPU();
+  std::string Features = TM->getTargetFeatureString();
+  TargetOptions Options = TM->Options;
+  Reloc::Model RM = TM->getRelocationModel();
+  CodeModel::Model CM = TM->getCodeModel();
+  CodeGenOpt::Level OL = TM->getOptLevel();
+  ConcurrentIRCompiler Compile([&]() {
+    return std::unique_ptr<TargetMachine>(
+        T.createTargetMachine(TT, CPU, Features, Options, RM, CM, OL));
+  });
+
+  RTDyldObjectLinkingLayer ObjLayer(
+      []() { return std::make_shared<SectionMemoryManager>(); });
+  ConcurrentIRCompileLayer<decltype(ObjLayer), ConcurrentIRCompiler>
+      CompileLayer(ObjLayer, std::move(Compile), 4);
+
+  // Every module has its own context, so that they can be compiled at the
+  // same time. Module I defines "int fI() { return I; }".
+  const unsigned NumModules = 8;
+  std::vector<std::unique_ptr<LLVMContext>> Contexts;
+  for (unsigned I = 0; I != NumModules; ++I) {
+    Contexts.push_back(llvm::make_unique<LLVMContext>());
+    LLVMContext &Ctx = *Contexts.back();
+    ModuleBuilder MB(Ctx, TM->getTargetTriple().str(), "M" + std::to_string(I));
+    MB.getModule()->setDataLayout(TM->createDataLayout());
+    Function *F =
+        MB.createFunctionDecl<int32_t(void)>("f" + std::to_string(I));
+    IRBuilder<> Builder(BasicBlock::Create(Ctx, "entry", F));
+    Builder.CreateRet(ConstantInt::getSigned(Type::getInt32Ty(Ctx), I));
+    cantFail(CompileLayer.addModule(MB.takeModule(),
+                                    std::make_shared<NullResolver>()));
+  }
+
+  for (unsigned I = 0; I != NumModules; ++I) {
+    std::string Name = "f" + std::to_string(I);
+    std::string MangledName;
+    {
+      raw_string_ostream MangledNameStream(MangledName);
+      Mangler::getNameWithPrefix(MangledNameStream, Name,
+                                 TM->createDataLayout());
+    }
+    auto Sym = CompileLayer.findSymbol(MangledName, true);
+    ASSERT_TRUE(!!Sym) << "Missing symbol " << Name;
+    auto *F = (int32_t(*)())cantFail(Sym.getAddress());
+    EXPECT_EQ(F(), int32_t(I)) << "Wrong result from " << Name;
+  }
+}
+
+} // end anonymous namespace
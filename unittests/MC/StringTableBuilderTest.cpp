@@ -12,6 +12,7 @@
 #include "llvm/Support/Endian.h"
 #include "gtest/gtest.h"
 #include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -104,4 +105,34 @@ TEST(StringTableBuilderTest, ELFInOrder) {
   EXPECT_EQ(9U, B.getOffset("foobar"));
 }
 
+TEST(StringTableBuilderTest, LargeELF) {
+  // Enough strings to sort the table in parallel. Every "symN" is a suffix of
+  // "x_symN" and must be merged into it.
+  std::vector<std::string> Strings;
+  for (unsigned I = 0; I != 70000; ++I) {
+    Strings.push_back("sym" + std::to_string(I));
+    Strings.push_back("x_sym" + std::to_string(I));
+  }
+
+  StringTableBuilder B(StringTableBuilder::ELF);
+  size_t ExpectedSize = 1;
+  for (const std::string &S : Strings) {
+    B.add(S);
+    if (S[0] == 'x')
+      ExpectedSize += S.size() + 1;
+  }
+  B.finalize();
+  EXPECT_EQ(ExpectedSize, B.getSize());
+
+  SmallString<0> Data;
+  raw_svector_ostream OS(Data);
+  B.write(OS);
+  for (const std::string &S : Strings) {
+    size_t Offset = B.getOffset(S);
+    ASSERT_LT(Offset + S.size(), Data.size());
+    EXPECT_EQ(S, StringRef(Data.data() + Offset, S.size()));
+    EXPECT_EQ('\0', Data[Offset + S.size()]);
+  }
+}
+
 }
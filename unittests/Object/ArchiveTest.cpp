@@ -0,0 +1,102 @@
+//===- ArchiveTest.cpp - Tests for Archive.cpp ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/Archive.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace object;
+
+namespace {
+
+void writeMemberHeader(raw_ostream &OS, StringRef Name, size_t Size) {
+  OS << left_justify(Name, 16) << left_justify("0", 12) << left_justify("0", 6)
+     << left_justify("0", 6) << left_justify("644", 8)
+     << left_justify(utostr(Size), 10) << "`\n";
+}
+
+void writeBE32(raw_ostream &OS, uint32_t Value) {
+  OS << char(Value >> 24) << char(Value >> 16) << char(Value >> 8)
+     << char(Value);
+}
+
+// A GNU archive with members a.o and b.o. a.o defines foo and baz, b.o
+// defines bar, and foo is also listed for b.o after a.o.
+std::string makeArchive() {
+  const char Names[] = "foo\0bar\0baz\0foo";
+  const uint32_t SymTabSize = 4 + 4 * 4 + sizeof(Names);
+  const uint32_t AOffset = 8 + 60 + SymTabSize;
+  const uint32_t BOffset = AOffset + 60 + 4;
+
+  std::string Buffer;
+  raw_string_ostream OS(Buffer);
+  OS << "!<arch>\n";
+  writeMemberHeader(OS, "/", SymTabSize);
+  writeBE32(OS, 4);
+  for (uint32_t Offset : {AOffset, BOffset, AOffset, BOffset})
+    writeBE32(OS, Offset);
+  OS << StringRef(Names, sizeof(Names));
+  writeMemberHeader(OS, "a.o/", 4);
+  OS << "aaaa";
+  writeMemberHeader(OS, "b.o/", 4);
+  OS << "bbbb";
+  return OS.str();
+}
+
+StringRef memberName(const Optional<Archive::Child> &C) {
+  if (!C)
+    return "<none>";
+  Expected<StringRef> NameOrErr = C->getName();
+  if (!NameOrErr) {
+    consumeError(NameOrErr.takeError());
+    return "<error>";
+  }
+  return *NameOrErr;
+}
+
+TEST(ArchiveTest, FindSym) {
+  std::string Buffer = makeArchive();
+  Expected<std::unique_ptr<Archive>> ArchiveOrErr =
+      Archive::create(MemoryBufferRef(Buffer, "test.a"));
+  ASSERT_TRUE(!!ArchiveOrErr);
+  Archive &A = **ArchiveOrErr;
+
+  auto Find = [&](StringRef Name) -> StringRef {
+    Expected<Optional<Archive::Child>> ChildOrErr = A.findSym(Name);
+    if (!ChildOrErr) {
+      consumeError(ChildOrErr.takeError());
+      return "<error>";
+    }
+    return memberName(*ChildOrErr);
+  };
+  EXPECT_EQ("a.o", Find("foo"));
+  EXPECT_EQ("b.o", Find("bar"));
+  EXPECT_EQ("a.o", Find("baz"));
+  EXPECT_EQ("<none>", Find("qux"));
+}
+
+TEST(ArchiveTest, FindSyms) {
+  std::string Buffer = makeArchive();
+  Expected<std::unique_ptr<Archive>> ArchiveOrErr =
+      Archive::create(MemoryBufferRef(Buffer, "test.a"));
+  ASSERT_TRUE(!!ArchiveOrErr);
+
+  StringRef Names[] = {"bar", "qux", "foo"};
+  auto ChildrenOrErr = (*ArchiveOrErr)->findSyms(Names);
+  ASSERT_TRUE(!!ChildrenOrErr);
+  ASSERT_EQ(3u, ChildrenOrErr->size());
+  EXPECT_EQ("b.o", memberName((*ChildrenOrErr)[0]));
+  EXPECT_EQ("<none>", memberName((*ChildrenOrErr)[1]));
+  EXPECT_EQ("a.o", memberName((*ChildrenOrErr)[2]));
+}
+
+} // end anonymous namespace
@@ -343,4 +343,13 @@ TEST(raw_fd_ostreamTest, multiple_raw_fd_ostream_to_stdout) {
   { raw_fd_ostream("-", EC, sys::fs::OpenFlags::F_None); }
   { raw_fd_ostream("-", EC, sys::fs::OpenFlags::F_None); }
 }
+
+TEST(raw_svector_ostreamTest, reserveExtraSpace) {
+  SmallString<0> Str;
+  raw_svector_ostream OS(Str);
+  OS << "abc";
+  OS.reserveExtraSpace(1000);
+  EXPECT_LE(1003U, Str.capacity());
+  EXPECT_EQ("abc", OS.str());
+}
 }